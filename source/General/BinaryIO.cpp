@@ -0,0 +1,129 @@
+#include "BinaryIO.h"
+
+#include <cstring>
+
+namespace pitaya {
+
+	namespace {
+
+		// bump it whenever the layout of any section changes
+		const std::uint32_t VERSION = 2;
+
+		// upper bound of a length, guards against allocating for a corrupt file
+		const std::size_t MAX_LENGTH = std::size_t(1) << 28;
+
+		bool little_endian() {
+			const std::uint32_t probe = 1;
+			return *reinterpret_cast<const unsigned char*>(&probe) == 1;
+		}
+
+	}
+
+	BinaryWriter::BinaryWriter(std::ostream& os)
+		: m_os {os} {}
+
+	void BinaryWriter::header(const char* tag) {
+		m_os.write(tag, 4);
+		word(VERSION);
+	}
+
+	void BinaryWriter::word(std::uint32_t w) {
+		char bytes[4];
+		for (auto& b : bytes) {
+			b = char(w & 0xff);
+			w >>= 8;
+		}
+		m_os.write(bytes, 4);
+	}
+
+	void BinaryWriter::string(const std::string& s) {
+		word(std::uint32_t(s.size()));
+		m_os.write(s.data(), s.size());
+	}
+
+	void BinaryWriter::strings(const std::vector<std::string>& v) {
+		word(std::uint32_t(v.size()));
+		for (auto& s : v) {
+			string(s);
+		}
+	}
+
+	bool BinaryWriter::good() const {
+		return m_os.good();
+	}
+
+	BinaryReader::BinaryReader(std::istream& is)
+		: m_is {is}, m_good {is.good()} {}
+
+	bool BinaryReader::header(const char* tag) {
+		char bytes[4] {};
+		if (m_good && !m_is.read(bytes, 4)) {
+			m_good = false;
+		}
+		if (!m_good || std::memcmp(bytes, tag, 4) != 0 || word() != VERSION) {
+			m_good = false;
+		}
+		return m_good;
+	}
+
+	std::uint32_t BinaryReader::word() {
+		unsigned char bytes[4] {};
+		if (m_good && !m_is.read(reinterpret_cast<char*>(bytes), 4)) {
+			m_good = false;
+		}
+		if (!m_good) return 0;
+		return std::uint32_t(bytes[0]) | std::uint32_t(bytes[1]) << 8
+			| std::uint32_t(bytes[2]) << 16 | std::uint32_t(bytes[3]) << 24;
+	}
+
+	std::string BinaryReader::string() {
+		std::size_t n;
+		if (!read_length(n)) return {};
+		std::string s(n, '\0');
+		if (n > 0 && !m_is.read(&s[0], n)) {
+			m_good = false;
+			return {};
+		}
+		return s;
+	}
+
+	std::vector<std::string> BinaryReader::strings() {
+		std::size_t n;
+		std::vector<std::string> v;
+		if (!read_length(n)) return v;
+		for (std::size_t i = 0; i < n && m_good; i++) {
+			v.push_back(string());
+		}
+		return v;
+	}
+
+	bool BinaryReader::good() const {
+		return m_good;
+	}
+
+	void BinaryReader::read_words(std::vector<std::uint32_t>& v) {
+		std::size_t n;
+		if (!read_length(n)) return;
+		// read the whole block at once, then fix the byte order if needed
+		v.resize(n);
+		if (n > 0 && !m_is.read(reinterpret_cast<char*>(v.data()), n * 4)) {
+			m_good = false;
+			v.clear();
+			return;
+		}
+		if (!little_endian()) {
+			for (auto& w : v) {
+				w = (w >> 24) | ((w >> 8) & 0xff00) | ((w << 8) & 0xff0000) | (w << 24);
+			}
+		}
+	}
+
+	bool BinaryReader::read_length(std::size_t& n) {
+		n = word();
+		if (n > MAX_LENGTH) {
+			m_good = false;
+		}
+		return m_good;
+	}
+
+}
\ No newline at end of file
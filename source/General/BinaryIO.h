@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace pitaya {
+
+	/*!
+		\ingroup General
+		BinaryWriter class.
+
+		Writes the binary table format: 32-bit little-endian words,
+		strings and vectors prefixed by their lengths,
+		and sections starting with a tag and the format version.
+	*/
+	class BinaryWriter {
+
+	public:
+
+		//! Constructor.
+		/*!
+			\param os A stream opened in binary mode.
+		*/
+		BinaryWriter(std::ostream& os);
+
+		//! Start a section.
+		/*!
+			\param tag Four characters naming the section.
+		*/
+		void header(const char* tag);
+
+		//! Write a word.
+		void word(std::uint32_t);
+
+		//! Write a string.
+		void string(const std::string&);
+
+		//! Write a vector of strings.
+		void strings(const std::vector<std::string>&);
+
+		//! Write a vector, every element is stored as a word.
+		template<typename T>
+		void words(const std::vector<T>& v) {
+			word(std::uint32_t(v.size()));
+			for (auto x : v) {
+				word(std::uint32_t(x));
+			}
+		}
+
+		//! Whether everything has been written.
+		bool good() const;
+
+	private:
+
+		std::ostream& m_os;		//!< The output stream.
+
+	};
+
+	/*!
+		\ingroup General
+		BinaryReader class.
+
+		Reads what BinaryWriter writes.
+		Vectors are read in one block, so loading tables costs little more than copying them.
+		Once anything goes wrong, every read fails and good() returns false.
+	*/
+	class BinaryReader {
+
+	public:
+
+		//! Constructor.
+		/*!
+			\param is A stream opened in binary mode.
+		*/
+		BinaryReader(std::istream& is);
+
+		//! Read the start of a section.
+		/*!
+			\return False if the tag or the format version differs.
+		*/
+		bool header(const char* tag);
+
+		//! Read a word.
+		std::uint32_t word();
+
+		//! Read a string.
+		std::string string();
+
+		//! Read a vector of strings.
+		std::vector<std::string> strings();
+
+		//! Read a vector written by BinaryWriter::words().
+		template<typename T>
+		std::vector<T> words() {
+			std::vector<std::uint32_t> raw;
+			read_words(raw);
+			return std::vector<T>(raw.begin(), raw.end());
+		}
+
+		//! Whether everything has been read.
+		bool good() const;
+
+	private:
+
+		std::istream& m_is;		//!< The input stream.
+		bool m_good;			//!< Whether no read has failed.
+
+		/// @cond
+		void read_words(std::vector<std::uint32_t>&);
+		bool read_length(std::size_t&);
+		/// @endcond
+
+	};
+
+}
\ No newline at end of file
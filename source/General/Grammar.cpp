@@ -1,330 +1,449 @@
-#include "Grammar.h"
-
-#include <fstream>
-#include <algorithm>
-#include <iostream>
-#include <cctype>
-
-namespace pitaya {
-
-	Grammar::Grammar(const std::string& file)
-		: m_symbols {}, m_productions {} {
-		Symbol::create("$");
-		read(file);
-		rearrange_symbols();
-		rearrange_productions();
-		compute_lambdas();
-	}
-
-	std::size_t Grammar::symbol_count() const {
-		return m_symbols.size();
-	}
-
-	std::size_t Grammar::production_count() const {
-		return m_productions.size();
-	}
-
-	Symbol& Grammar::get_symbol(std::size_t index) {
-		return *m_symbols[index];
-	}
-
-	Symbol& Grammar::get_symbol(std::string name) {
-		auto& find = Symbol::pool().find(name);
-		if (find != Symbol::pool().end()) {
-			return *(find->second);
-		}
-		return endmark();
-	}
-
-	Production& Grammar::get_production(ProductionID id) {
-		return m_productions[id];
-	}
-
-	Grammar::PP Grammar::productions_by_lhs(const Symbol& lhs) {
-		assert(lhs.type() == SymbolType::NONTERMINAL);
-		return m_productions_by_lhs.at(lhs.rank);
-	}
-
-	Symbol& Grammar::endmark() {
-		return *m_symbols[0];
-	}
-
-	Grammar::SymbolIterator Grammar::terminal_begin() {
-		return m_terminal_start;
-	}
-
-	Grammar::SymbolIterator Grammar::terminal_end() {
-		return m_terminal_end;
-	}
-
-	Grammar::SymbolIterator Grammar::nonterminal_begin() {
-		return m_nonterminal_start;
-	}
-
-	Grammar::SymbolIterator Grammar::nonterminal_end() {
-		return m_nonterminal_end;
-	}
-
-	Grammar::SymbolIterator Grammar::symbol_begin() {
-		return m_symbols.begin();
-	}
-
-	Grammar::SymbolIterator Grammar::symbol_end() {
-		return m_symbols.end();
-	}
-
-	void Grammar::rearrange_symbols() {
-		// after reading grammar file, every nonterminal has been determined
-		for (const auto& p : Symbol::pool()) {
-			if (p.second->m_type == SymbolType::UNDEFINED) {
-				p.second->m_type = SymbolType::TERMINAL;
-			}
-			m_symbols.emplace_back(p.second);
-		}
-
-		// sort terminals before nonterminals while
-		// keeping the order they appeared in the grammar file
-		std::sort(m_symbols.begin(), m_symbols.end(), [](auto& a, auto& b) {
-			if (a->type() != b->type()) {
-				return to_integral(a->type()) < to_integral(b->type());
-			}
-			else {
-				return a->rank < b->rank;
-			}
-		});
-
-		m_terminal_start = m_symbols.begin();
-		m_terminal_end = m_symbols.end();
-		m_nonterminal_start = m_symbols.end();
-		m_nonterminal_end = m_symbols.end();
-
-		// set symbols' index and symbol iterators
-		// note iterators depend on how symbols are sorted
-		std::size_t index = 0;
-		for (auto it = m_symbols.begin(); it != m_symbols.end(); it++) {
-			(*it)->m_index = index++;
-			if (m_terminal_end == m_symbols.end()
-				&& (*it)->m_type != SymbolType::TERMINAL) {
-				m_terminal_end = it;
-			}
-			if (m_nonterminal_start == m_symbols.end()
-				&& (*it)->m_type == SymbolType::NONTERMINAL) {
-				m_nonterminal_start = it;
-			}
-			if (m_nonterminal_end == m_symbols.end()
-				&& (*it)->m_type == SymbolType::MULTITERMINAL) {
-				m_nonterminal_end = it;
-			}
-		}
-	}
-
-	void Grammar::rearrange_productions() {
-		assert(m_productions.size() > 0);
-
-		// sort productions by lhs then by rank
-		std::sort(m_productions.begin(), m_productions.end(), [](auto& a, auto& b) {
-			if (a[0] == b[0]) {
-				return a.m_rank < b.m_rank;
-			}
-			else {
-				return a[0].rank < b[0].rank;
-			}
-		});
-
-		auto curr_lhs = m_productions[0][0].rank;
-		std::size_t start = 0;
-		for (std::size_t i = 0; i < m_productions.size(); i++) {
-			if (m_productions[i][0].rank != curr_lhs) {
-				m_productions_by_lhs.emplace(curr_lhs, PP {start, i - 1});
-				curr_lhs = m_productions[i][0].rank;
-				start = i;
-			}
-			m_productions[i].m_id = i;
-		}
-		// the last group
-		m_productions_by_lhs.emplace(curr_lhs, PP {start, m_productions.size() - 1});
-	}
-
-	void Grammar::compute_lambdas() {
-		bool not_fin = false;
-		// compute all lambdas
-		do {
-			not_fin = false;
-			for (auto& p : m_productions) {
-				if (p[0].lambda()) continue;
-				std::size_t i = 0;
-				for (i; i < p.rhs_count(); i++) {
-					auto& rhs = p[i + 1];
-					assert(rhs.type() == SymbolType::NONTERMINAL || !rhs.lambda());
-					if (!rhs.lambda()) break;		// lhs is lambda <=> all rhs are lambda
-				}
-				if (i == p.rhs_count()) {				// including zero rhs
-					p[0].lambda() = true;
-					not_fin = true;					// find a new lambda, continue computing
-				}
-			}
-		} while (not_fin);
-	}
-
-	void Grammar::read(const std::string& file) {
-		std::ifstream f;
-		f.open(file);
-		if (f.is_open()) {
-			// eat '\n's
-			while (f.peek() == '\n') {
-				f.get();
-			}
-			ProductionReader reader;
-			reader.initiate();
-			while (f.peek() != std::ifstream::traits_type::eof()) {
-				reader.read(f, m_productions);
-			}
-			reader.terminate();
-		}
-		f.close();
-	}
-
-	void Grammar::print_first_sets() const {
-		for (const auto& s : m_symbols) {
-			if (s->type() == SymbolType::NONTERMINAL) {
-				std::cout << "[ " << *s << " ]\n";
-				for (const auto& s2 : m_symbols) {
-					if (s->first_set()[*s2]) {
-						std::cout << '\t' << *s2;
-					}
-				}
-				if (s->lambda()) {
-					std::cout << "\t(empty)";
-				}
-				std::cout << std::endl;
-			}
-		}
-	}
-
-	Grammar::ProductionReader::ProductionReader()
-		: curr_pid {}, curr_assc {}, curr_prec {-1},
-		token_decl {false}, multi_decl {false}, curr_multi {nullptr} {}
-
-	void Grammar::ProductionReader::read(std::ifstream& file,
-										 std::vector<pitaya::Production>& productions) {
-		if (state_downcast<const WaitForLHS*>() != nullptr) {
-			if (file.peek() == '%') {
-				file.get();
-				process_event(EvStartDecl {});
-			}
-			else {
-				std::string lhs;
-				file >> lhs;
-				productions.emplace_back(curr_pid, Symbol::create(lhs));
-				productions[curr_pid][0].m_type = SymbolType::NONTERMINAL;
-				process_event(EvGetSymbol {});
-			}
-		}
-		else if (state_downcast<const WaitForDecl*>() != nullptr) {
-			if (std::isalpha(file.peek())) {
-				std::string s;
-				file >> s;
-				curr_assc = Associativity::UNDEFINED;
-				if (s == "left") curr_assc = Associativity::LEFT;
-				if (s == "right") curr_assc = Associativity::RIGHT;
-				if (s == "none") curr_assc = Associativity::NONE;
-				if (s == "token") token_decl = true;
-				if (s == "multi") multi_decl = true;
-				if (curr_assc != Associativity::UNDEFINED || token_decl) {
-					curr_prec++;
-					process_event(EvStartDecl {});
-				}
-				else if (multi_decl) {
-					curr_multi = nullptr;
-					process_event(EvStartDecl {});
-				}
-			}
-			process_event(EvStartComm {});
-		}
-		else if (state_downcast<const ReadComment*>() != nullptr) {
-			while (file.peek() != '\n' && file.peek() != std::ifstream::traits_type::eof()) {
-				file.get();
-			}
-			// eat '\n's
-			while (file.peek() == '\n') {
-				file.get();
-			}
-			process_event(EvNextProduction {});
-		}
-		else if (state_downcast<const WaitForSyms*>() != nullptr) {
-			if (file.peek() == '\n') {
-				// eat '\n's
-				while (file.peek() == '\n') {
-					file.get();
-				}
-				token_decl = false;
-				multi_decl = false;
-				process_event(EvNextProduction {});
-			}
-			else {
-				std::string s;
-				file >> s;
-				auto& sym = Symbol::create(s);
-				if (multi_decl) {
-					if (curr_multi != nullptr) {
-						sym->m_type = SymbolType::MULTITERMINAL;
-						sym->m_shared_terminal = curr_multi;
-					}
-					else {
-						sym->m_type = SymbolType::TERMINAL;
-						curr_multi = sym.get();
-					}
-				}
-				else {
-					sym->m_associativity = curr_assc;
-					sym->m_precedence = curr_prec;
-					if (token_decl) {
-						sym->m_is_token = true;
-					}
-				}
-				process_event(EvGetSymbol {});
-			}
-		}
-		else {
-			if (file.peek() == '\n') {
-				// eat '\n's
-				while (file.peek() == '\n') {
-					file.get();
-				}
-				curr_pid++;
-				process_event(EvNextProduction {});
-			}
-			else {
-				std::string rhs;
-				file >> rhs;
-				productions[curr_pid].m_rhs.emplace_back(std::move(Symbol::create(rhs)));
-				process_event(EvGetSymbol {});
-			}
-		}
-	}
-
-	sc::result Grammar::WaitForLHS::react(const EvGetSymbol& ev) {
-		return transit<WaitForRHS>();
-	}
-
-	sc::result Grammar::WaitForLHS::react(const EvStartDecl& ev) {
-		return transit<WaitForDecl>();
-	}
-
-	sc::result Grammar::WaitForRHS::react(const EvGetSymbol& ev) {
-		return discard_event();
-	}
-
-	sc::result Grammar::WaitForDecl::react(const EvStartDecl& ev) {
-		return transit<WaitForSyms>();
-	}
-
-	sc::result Grammar::WaitForDecl::react(const EvStartComm& ev) {
-		return transit<ReadComment>();
-	}
-
-	sc::result Grammar::WaitForSyms::react(const EvGetSymbol& ev) {
-		return discard_event();
-	}
-
+#include "Grammar.h"
+
+#include <fstream>
+#include <algorithm>
+#include <iostream>
+#include <cctype>
+#include <cstring>
+
+#include <boost\functional\hash\hash.hpp>
+
+namespace pitaya {
+
+	Grammar::Grammar(const std::string& file)
+		: m_symbols {}, m_productions {}, m_rhs {}, m_next_rank {}, m_names {}, m_indices {}, m_text {}, m_ranks {}, m_multis {} {
+		intern("$");
+		read(file);
+		m_next_rank = m_productions.size();
+		rearrange_symbols();
+		rearrange_productions();
+		compute_lambdas();
+	}
+
+	std::size_t Grammar::symbol_count() const {
+		return m_symbols.size();
+	}
+
+	std::size_t Grammar::production_count() const {
+		return m_productions.size();
+	}
+
+	Symbol& Grammar::get_symbol(std::size_t index) {
+		return m_symbols[index];
+	}
+
+	Symbol& Grammar::get_symbol(boost::string_ref name) {
+		auto find = m_indices.find(name);
+		if (find != m_indices.end()) {
+			return m_symbols[find->second];
+		}
+		return endmark();
+	}
+
+	Production& Grammar::get_production(ProductionID id) {
+		return m_productions[id];
+	}
+
+	Grammar::PP Grammar::productions_by_lhs(const Symbol& lhs) {
+		assert(lhs.type() == SymbolType::NONTERMINAL);
+		return m_productions_by_lhs.at(lhs.rank);
+	}
+
+	Symbol& Grammar::endmark() {
+		return m_symbols[0];
+	}
+
+	Grammar::SymbolIterator Grammar::terminal_begin() {
+		return m_terminal_start;
+	}
+
+	Grammar::SymbolIterator Grammar::terminal_end() {
+		return m_terminal_end;
+	}
+
+	Grammar::SymbolIterator Grammar::nonterminal_begin() {
+		return m_nonterminal_start;
+	}
+
+	Grammar::SymbolIterator Grammar::nonterminal_end() {
+		return m_nonterminal_end;
+	}
+
+	Grammar::SymbolIterator Grammar::symbol_begin() {
+		return m_symbols.begin();
+	}
+
+	Grammar::SymbolIterator Grammar::symbol_end() {
+		return m_symbols.end();
+	}
+
+	std::uint64_t Grammar::fingerprint() const {
+		// 64-bit FNV-1a
+		std::uint64_t hash = 14695981039346656037ull;
+		auto add = [&hash](std::uint64_t value) {
+			for (auto i = 0; i < 8; i++) {
+				hash ^= value & 0xff;
+				hash *= 1099511628211ull;
+				value >>= 8;
+			}
+		};
+		add(m_symbols.size());
+		for (auto& s : m_symbols) {
+			add(std::strlen(s.m_name));
+			for (auto c = s.m_name; *c != '\0'; c++) {
+				add(static_cast<unsigned char>(*c));
+			}
+			add(to_integral(s.m_type));
+			add(std::uint64_t(s.m_precedence));
+			add(to_integral(s.m_associativity));
+			add(s.m_is_token);
+			add(s.m_type == SymbolType::MULTITERMINAL ? s.m_shared_terminal->m_index : 0);
+		}
+		add(m_productions.size());
+		for (auto& p : m_productions) {
+			add(p.rank());
+			add(p.rhs_count());
+			for (std::size_t i = 0; i <= p.rhs_count(); i++) {
+				add(p[i].index());
+			}
+		}
+		return hash;
+	}
+
+	bool Grammar::add_production(boost::string_ref lhs, const std::vector<boost::string_ref>& rhs) {
+		auto find = m_indices.find(lhs);
+		if (find == m_indices.end() || m_symbols[find->second].type() != SymbolType::NONTERMINAL) return false;
+		std::vector<std::size_t> indices;
+		if (!find_symbols(rhs, indices)) return false;
+		insert_production(find->second, indices);
+		return true;
+	}
+
+	bool Grammar::remove_production(ProductionID id) {
+		// the first production is the augmented one
+		if (id == 0 || id >= m_productions.size()) return false;
+		auto range = m_productions_by_lhs.at(m_productions[id][0].rank);
+		if (range.first == range.second) return false;
+		// rhs stay in the pool unused
+		m_productions.erase(m_productions.begin() + id);
+		rearrange_productions();
+		compute_lambdas();
+		return true;
+	}
+
+	bool Grammar::replace_production(ProductionID id, const std::vector<boost::string_ref>& rhs) {
+		std::vector<std::size_t> indices;
+		if (id == 0 || id >= m_productions.size() || !find_symbols(rhs, indices)) return false;
+		// the production keeps its rank and id, only its rhs moves to the end of the pool
+		// the old rhs stays in the pool unused
+		auto& production = m_productions[id];
+		production.m_offset = append_rhs(indices);
+		production.m_rhs_count = indices.size();
+		production.m_rhs = m_rhs.data() + production.m_offset;
+		compute_lambdas();
+		return true;
+	}
+
+	void Grammar::insert_production(std::size_t lhs, const std::vector<std::size_t>& rhs) {
+		auto offset = append_rhs(rhs);
+		m_productions.emplace_back(m_next_rank++, lhs, offset);
+		m_productions.back().m_rhs_count = rhs.size();
+		m_productions.back().m_symbols = m_symbols.data();
+		m_productions.back().m_rhs = m_rhs.data() + offset;
+		rearrange_productions();
+		compute_lambdas();
+	}
+
+	std::size_t Grammar::append_rhs(const std::vector<std::size_t>& rhs) {
+		auto offset = m_rhs.size();
+		m_rhs.insert(m_rhs.end(), rhs.begin(), rhs.end());
+		// the rhs pool may have moved
+		for (auto& p : m_productions) {
+			p.m_rhs = m_rhs.data() + p.m_offset;
+		}
+		return offset;
+	}
+
+	bool Grammar::find_symbols(const std::vector<boost::string_ref>& names, std::vector<std::size_t>& indices) const {
+		indices.clear();
+		for (auto name : names) {
+			auto find = m_indices.find(name);
+			if (find == m_indices.end()) return false;
+			indices.push_back(find->second);
+		}
+		return true;
+	}
+
+	std::size_t Grammar::NameHash::operator()(boost::string_ref name) const {
+		return boost::hash_range(name.begin(), name.end());
+	}
+
+	Symbol& Grammar::intern(boost::string_ref name) {
+		auto res = m_ranks.emplace(name, m_symbols.size());
+		if (res.second) {
+			m_symbols.push_back(Symbol {nullptr, res.first->second});
+		}
+		return m_symbols[res.first->second];
+	}
+
+	void Grammar::rearrange_symbols() {
+		// after reading grammar file, every nonterminal has been determined
+		for (auto& s : m_symbols) {
+			if (s.m_type == SymbolType::UNDEFINED) {
+				s.m_type = SymbolType::TERMINAL;
+			}
+		}
+
+		// sort terminals before nonterminals while
+		// keeping the order they appeared in the grammar file
+		// symbols are read in order of rank, so ranks are their positions now
+		std::vector<Rank> order;
+		for (Rank r = 0; r < m_symbols.size(); r++) {
+			order.push_back(r);
+		}
+		std::sort(order.begin(), order.end(), [this](auto a, auto b) {
+			auto ta = to_integral(m_symbols[a].type()), tb = to_integral(m_symbols[b].type());
+			return ta != tb ? ta < tb : a < b;
+		});
+		std::vector<std::size_t> index_of(m_symbols.size());
+		std::vector<Symbol> symbols;
+		symbols.reserve(m_symbols.size());
+		for (std::size_t i = 0; i < order.size(); i++) {
+			index_of[order[i]] = i;
+			symbols.push_back(std::move(m_symbols[order[i]]));
+			symbols.back().m_index = i;
+		}
+		m_symbols = std::move(symbols);
+
+		// names go to one arena, which must not grow once symbols refer to it
+		std::vector<boost::string_ref> names(m_symbols.size());
+		std::size_t length = 0;
+		for (auto& p : m_ranks) {
+			names[index_of[p.second]] = p.first;
+			length += p.first.size() + 1;
+		}
+		m_names.reserve(length);
+		std::vector<std::size_t> offsets;
+		for (auto name : names) {
+			offsets.push_back(m_names.size());
+			m_names.append(name.data(), name.size()).push_back('\0');
+		}
+		for (std::size_t i = 0; i < m_symbols.size(); i++) {
+			m_symbols[i].m_name = m_names.data() + offsets[i];
+			m_indices.emplace(boost::string_ref(m_symbols[i].m_name, names[i].size()), i);
+		}
+		m_ranks.clear();
+		std::string().swap(m_text);
+
+		for (auto& multi : m_multis) {
+			m_symbols[index_of[multi.first]].m_shared_terminal = &m_symbols[index_of[multi.second]];
+		}
+		m_multis.clear();
+
+		// productions refer to symbols by index from now on
+		for (auto& index : m_rhs) {
+			index = index_of[index];
+		}
+		for (auto& p : m_productions) {
+			p.m_lhs = index_of[p.m_lhs];
+			p.m_symbols = m_symbols.data();
+			p.m_rhs = m_rhs.data() + p.m_offset;
+		}
+
+		m_terminal_start = m_symbols.begin();
+		m_terminal_end = m_symbols.end();
+		m_nonterminal_start = m_symbols.end();
+		m_nonterminal_end = m_symbols.end();
+
+		// set symbol iterators
+		// note iterators depend on how symbols are sorted
+		for (auto it = m_symbols.begin(); it != m_symbols.end(); it++) {
+			if (m_terminal_end == m_symbols.end()
+				&& it->m_type != SymbolType::TERMINAL) {
+				m_terminal_end = it;
+			}
+			if (m_nonterminal_start == m_symbols.end()
+				&& it->m_type == SymbolType::NONTERMINAL) {
+				m_nonterminal_start = it;
+			}
+			if (m_nonterminal_end == m_symbols.end()
+				&& it->m_type == SymbolType::MULTITERMINAL) {
+				m_nonterminal_end = it;
+			}
+		}
+	}
+
+	void Grammar::rearrange_productions() {
+		assert(m_productions.size() > 0);
+
+		// sort productions by lhs then by rank
+		std::sort(m_productions.begin(), m_productions.end(), [](auto& a, auto& b) {
+			if (a[0] == b[0]) {
+				return a.m_rank < b.m_rank;
+			}
+			else {
+				return a[0].rank < b[0].rank;
+			}
+		});
+
+		m_productions_by_lhs.clear();
+		auto curr_lhs = m_productions[0][0].rank;
+		std::size_t start = 0;
+		for (std::size_t i = 0; i < m_productions.size(); i++) {
+			if (m_productions[i][0].rank != curr_lhs) {
+				m_productions_by_lhs.emplace(curr_lhs, PP {start, i - 1});
+				curr_lhs = m_productions[i][0].rank;
+				start = i;
+			}
+			m_productions[i].m_id = i;
+		}
+		// the last group
+		m_productions_by_lhs.emplace(curr_lhs, PP {start, m_productions.size() - 1});
+	}
+
+	void Grammar::compute_lambdas() {
+		// start over, an edit may have taken lambdas away
+		for (auto it = m_nonterminal_start; it != m_nonterminal_end; it++) {
+			it->m_lambda = false;
+		}
+
+		// lhs is lambda <=> all rhs are lambda
+		// count the rhs of each production not known to be lambda yet,
+		// and visit the productions using a symbol once it is found lambda
+		std::vector<std::size_t> remaining(m_productions.size());
+		std::vector<std::vector<ProductionID>> users(m_symbols.size());
+		std::vector<std::size_t> worklist;
+		for (auto& p : m_productions) {
+			remaining[p.id()] = p.rhs_count();
+			for (std::size_t i = 1; i <= p.rhs_count(); i++) {
+				if (p[i].type() == SymbolType::NONTERMINAL) {
+					users[p[i].index()].push_back(p.id());
+				}
+			}
+			if (p.rhs_count() == 0 && !p[0].lambda()) {
+				p[0].lambda() = true;
+				worklist.push_back(p[0].index());
+			}
+		}
+		while (!worklist.empty()) {
+			auto index = worklist.back();
+			worklist.pop_back();
+			for (auto pid : users[index]) {
+				auto& lhs = m_productions[pid][0];
+				if (--remaining[pid] == 0 && !lhs.lambda()) {
+					lhs.lambda() = true;
+					worklist.push_back(lhs.index());
+				}
+			}
+		}
+	}
+
+	void Grammar::read(const std::string& file) {
+		std::ifstream f;
+		f.open(file, std::ios::binary);
+		if (!f.is_open()) return;
+		f.seekg(0, std::ios::end);
+		auto size = f.tellg();
+		if (size > 0) {
+			m_text.resize(std::size_t(size));
+			f.seekg(0, std::ios::beg);
+			f.read(&m_text[0], m_text.size());
+			m_text.resize(std::size_t(f.gcount()));
+		}
+		f.close();
+
+		auto space = [](char c) {
+			return std::isspace(static_cast<unsigned char>(c)) != 0;
+		};
+		int curr_prec = -1;
+		std::vector<boost::string_ref> words;
+		auto p = m_text.data(), end = p + m_text.size();
+		while (p != end) {
+			// split a line into words, '\r' of CRLF files is white space as well
+			auto eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+			if (eol == nullptr) {
+				eol = end;
+			}
+			words.clear();
+			while (p != eol) {
+				while (p != eol && space(*p)) {
+					p++;
+				}
+				auto start = p;
+				while (p != eol && !space(*p)) {
+					p++;
+				}
+				if (p != start) {
+					words.emplace_back(start, p - start);
+				}
+			}
+			if (p != end) {
+				p++;
+			}
+			if (words.empty()) continue;
+
+			if (words[0][0] != '%') {
+				auto& lhs = intern(words[0]);
+				lhs.m_type = SymbolType::NONTERMINAL;
+				m_productions.emplace_back(Rank(m_productions.size()), lhs.rank, m_rhs.size());
+				for (std::size_t i = 1; i < words.size(); i++) {
+					m_rhs.push_back(intern(words[i]).rank);
+				}
+				m_productions.back().m_rhs_count = words.size() - 1;
+				continue;
+			}
+
+			auto keyword = words[0].substr(1);
+			auto assc = Associativity::UNDEFINED;
+			if (keyword == "left") assc = Associativity::LEFT;
+			if (keyword == "right") assc = Associativity::RIGHT;
+			if (keyword == "none") assc = Associativity::NONE;
+			bool token_decl = keyword == "token";
+			if (assc != Associativity::UNDEFINED || token_decl) {
+				// every declaration line is one level higher than the previous
+				curr_prec++;
+				for (std::size_t i = 1; i < words.size(); i++) {
+					auto& symbol = intern(words[i]);
+					symbol.m_associativity = assc;
+					symbol.m_precedence = curr_prec;
+					if (token_decl) {
+						symbol.m_is_token = true;
+					}
+				}
+			}
+			else if (keyword == "multi") {
+				// the first symbol is the terminal shared by the rest
+				auto shared = Rank(-1);
+				for (std::size_t i = 1; i < words.size(); i++) {
+					auto& symbol = intern(words[i]);
+					if (shared != Rank(-1)) {
+						symbol.m_type = SymbolType::MULTITERMINAL;
+						m_multis.emplace_back(symbol.rank, shared);
+					}
+					else {
+						symbol.m_type = SymbolType::TERMINAL;
+						shared = symbol.rank;
+					}
+				}
+			}
+			// otherwise a comment
+		}
+	}
+
+	void Grammar::print_first_sets() {
+		for (auto& s : m_symbols) {
+			if (s.type() == SymbolType::NONTERMINAL) {
+				std::cout << "[ " << s << " ]\n";
+				auto& first = s.first_set();
+				for (auto i = first.find_first(); i != SymbolSet::npos; i = first.find_next(i)) {
+					std::cout << '\t' << m_symbols[i];
+				}
+				if (s.lambda()) {
+					std::cout << "\t(empty)";
+				}
+				std::cout << std::endl;
+			}
+		}
+	}
+
 }
\ No newline at end of file
@@ -1,189 +1,182 @@
-#pragma once
-
-#include "Production.h"
-
-#include <boost/statechart/state_machine.hpp>
-#include <boost/statechart/simple_state.hpp>
-#include <boost/statechart/event.hpp>
-#include <boost/statechart/custom_reaction.hpp>
-#include <boost/statechart/transition.hpp>
-#include <boost/mpl/list.hpp>
-
-namespace pitaya {
-
-	namespace sc = boost::statechart;
-
-	/*!
-		\ingroup General
-		Grammar class.
-	*/
-	class Grammar {
-
-		using PP = std::pair<ProductionID, ProductionID>;
-		using SymbolIterator = std::vector<SharedSymbol>::iterator;
-
-	public:
-
-		//! Constructor.
-		/*!
-			\param file Grammar file name.
-		*/
-		Grammar(const std::string&);
-
-		//! Number of symbols in this grammar.
-		std::size_t symbol_count() const;
-
-		//! Number of productions in this grammar.
-		std::size_t production_count() const;
-
-		//! Get a symbol by index.
-		Symbol& get_symbol(std::size_t);
-
-		//! Get a symbol by name.
-		Symbol& get_symbol(std::string);
-
-		//! Get a production by id.
-		Production& get_production(ProductionID);
-
-		//! Get productions with same lhs.
-		/*!
-			\return A pair indicating the start and the end production id.
-		*/
-		PP productions_by_lhs(const Symbol&);
-
-		//! Get the end-mark symbol.
-		Symbol& endmark();
-
-		//! Get an iterator to the beginning of terminals.
-		SymbolIterator terminal_begin();
-
-		//! Get an iterator to the end of terminals.
-		SymbolIterator terminal_end();
-
-		//! Get an iterator to the beginning of nonterminals.
-		SymbolIterator nonterminal_begin();
-
-		//! Get an iterator to the end of nonterminals.
-		SymbolIterator nonterminal_end();
-
-		//! Get an iterator to the beginning of symbols.
-		SymbolIterator symbol_begin();
-
-		//! Get an iterator to the end of symbols.
-		SymbolIterator symbol_end();
-
-		/// @cond
-		void print_first_sets() const;
-		/// @endcond
-
-	private:
-
-		std::vector<SharedSymbol> m_symbols;	//!< All symbols in this grammar.
-		std::vector<Production> m_productions;	//!< All productions in this grammar.
-
-		SymbolIterator m_terminal_start;		//!< The beginning of terminals.
-		SymbolIterator m_terminal_end;			//!< The end of terminals.
-		SymbolIterator m_nonterminal_start;		//!< The beginning of nonterminals.
-		SymbolIterator m_nonterminal_end;		//!< The end of nonterminals.
-
-		//! Productions grouped by their lhs.
-		std::unordered_map<Rank, PP> m_productions_by_lhs;
-
-		//! Parse a grammar file.
-		void read(const std::string&);
-
-		/// @cond
-		void rearrange_symbols();
-		void rearrange_productions();
-		void compute_lambdas();
-		/// @endcond
-
-		/// @cond boost
-		// forward state declarations
-		struct WaitForLHS;
-		struct WaitForRHS;
-		struct WaitForDecl;
-		struct WaitForSyms;
-		struct ReadComment;
-
-		// event definitions
-		struct EvGetSymbol : sc::event<EvGetSymbol> {};
-		struct EvNextProduction : sc::event<EvNextProduction> {};
-		struct EvStartDecl : sc::event<EvStartDecl> {};
-		struct EvStartComm : sc::event<EvStartComm> {};
-
-		// FSM definition
-		struct ProductionReader : sc::state_machine<ProductionReader, WaitForLHS> {
-
-			ProductionReader();
-
-			ProductionID curr_pid;
-			Associativity curr_assc;
-			int curr_prec;
-			bool token_decl;
-			bool multi_decl;
-			Symbol* curr_multi;
-
-			void read(std::ifstream&, std::vector<pitaya::Production>&);
-
-		};
-
-		// state definitions
-		struct WaitForLHS : sc::simple_state<WaitForLHS, ProductionReader> {
-
-			using reactions = boost::mpl::list<
-				sc::custom_reaction<EvGetSymbol>,
-				sc::custom_reaction<EvStartDecl>
-			>;
-
-			sc::result react(const EvGetSymbol&);
-			sc::result react(const EvStartDecl&);
-
-		};
-
-		struct WaitForRHS : sc::simple_state<WaitForRHS, ProductionReader> {
-
-			using reactions = boost::mpl::list<
-				sc::custom_reaction<EvGetSymbol>,
-				sc::transition<EvNextProduction, WaitForLHS>
-			>;
-
-			sc::result react(const EvGetSymbol&);
-
-		};
-
-		struct WaitForDecl : sc::simple_state<WaitForDecl, ProductionReader> {
-
-			using reactions = boost::mpl::list<
-				sc::custom_reaction<EvStartDecl>,
-				sc::custom_reaction<EvStartComm>
-			>;
-
-			sc::result react(const EvStartDecl&);
-			sc::result react(const EvStartComm&);
-
-		};
-
-		struct WaitForSyms : sc::simple_state<WaitForSyms, ProductionReader> {
-
-			using reactions = boost::mpl::list<
-				sc::custom_reaction<EvGetSymbol>,
-				sc::transition<EvNextProduction, WaitForLHS>
-			>;
-
-			sc::result react(const EvGetSymbol&);
-
-		};
-
-		struct ReadComment : sc::simple_state<ReadComment, ProductionReader> {
-
-			using reactions = boost::mpl::list<
-				sc::transition<EvNextProduction, WaitForLHS>
-			>;
-
-		};
-		/// @endcond
-
-	};
-
+#pragma once
+
+#include "Production.h"
+
+#include <unordered_map>
+
+#include <boost\utility\string_ref.hpp>
+
+namespace pitaya {
+
+	/*!
+		\ingroup General
+		Grammar class.
+	*/
+	class Grammar {
+
+		using PP = std::pair<ProductionID, ProductionID>;
+		using SymbolIterator = std::vector<Symbol>::iterator;
+
+	public:
+
+		//! Constructor.
+		/*!
+			\param file Grammar file name.
+		*/
+		Grammar(const std::string&);
+
+		//! Productions and symbols refer to the tables of their grammar, so it is not copyable.
+		Grammar(const Grammar&) = delete;
+		Grammar& operator=(const Grammar&) = delete;
+
+		//! Number of symbols in this grammar.
+		std::size_t symbol_count() const;
+
+		//! Number of productions in this grammar.
+		std::size_t production_count() const;
+
+		//! Get a symbol by index.
+		Symbol& get_symbol(std::size_t);
+
+		//! Get a symbol by name.
+		/*!
+			\return The end-mark if the symbol is undefined.
+		*/
+		Symbol& get_symbol(boost::string_ref);
+
+		//! Get a production by id.
+		Production& get_production(ProductionID);
+
+		//! Get productions with same lhs.
+		/*!
+			\return A pair indicating the start and the end production id.
+		*/
+		PP productions_by_lhs(const Symbol&);
+
+		//! Get the end-mark symbol.
+		Symbol& endmark();
+
+		//! Get an iterator to the beginning of terminals.
+		SymbolIterator terminal_begin();
+
+		//! Get an iterator to the end of terminals.
+		SymbolIterator terminal_end();
+
+		//! Get an iterator to the beginning of nonterminals.
+		SymbolIterator nonterminal_begin();
+
+		//! Get an iterator to the end of nonterminals.
+		SymbolIterator nonterminal_end();
+
+		//! Get an iterator to the beginning of symbols.
+		SymbolIterator symbol_begin();
+
+		//! Get an iterator to the end of symbols.
+		SymbolIterator symbol_end();
+
+		//! Add a production.
+		/*!
+			Only symbols of the grammar can be used, and the lhs must be a nonterminal.
+			The production ranks after all others, and production ids are renumbered.
+			\return Whether the production is added.
+		*/
+		bool add_production(boost::string_ref lhs, const std::vector<boost::string_ref>& rhs);
+
+		//! Remove a production.
+		/*!
+			Production ids are renumbered.
+			\return Whether the production is removed, neither the first production
+			nor the only production of a nonterminal can be removed.
+		*/
+		bool remove_production(ProductionID);
+
+		//! Replace the rhs of a production.
+		/*!
+			The production keeps its rank, and so its id and its priority in reduce-reduce conflicts,
+			as if its line in the grammar file were edited in place.
+			\return Whether the production is replaced.
+		*/
+		bool replace_production(ProductionID, const std::vector<boost::string_ref>& rhs);
+
+		//! Hash of the normalized grammar.
+		/*!
+			Covers every symbol with its type, precedence, associativity, token flag and multi-terminal group,
+			and every production with its rank, but not the layout or comments of the grammar file.
+			The hash is stable across runs and platforms, so it can key tables stored on disk.
+		*/
+		std::uint64_t fingerprint() const;
+
+		/// @cond
+		void print_first_sets();
+		/// @endcond
+
+	private:
+
+		std::vector<Symbol> m_symbols;			//!< All symbols in this grammar, by index.
+		std::vector<Production> m_productions;	//!< All productions in this grammar.
+		std::vector<std::size_t> m_rhs;			//!< Rhs of all productions, as symbol indices.
+		Rank m_next_rank;						//!< Rank of the next added production, never reused.
+
+		/// @cond
+		struct NameHash {
+			std::size_t operator()(boost::string_ref) const;
+		};
+		/// @endcond
+
+		std::string m_names;					//!< Names of all symbols, separated by '\0'.
+		//! Symbol indices by name, the keys refer to m_names.
+		std::unordered_map<boost::string_ref, std::size_t, NameHash> m_indices;
+
+		//! Contents of the grammar file, used while reading only.
+		std::string m_text;
+		//! Symbol ranks by name, the keys refer to m_text, used while reading only.
+		std::unordered_map<boost::string_ref, Rank, NameHash> m_ranks;
+		//! Shared symbol of each multi-terminal, by rank, used while reading only.
+		std::vector<std::pair<Rank, Rank>> m_multis;
+
+		SymbolIterator m_terminal_start;		//!< The beginning of terminals.
+		SymbolIterator m_terminal_end;			//!< The end of terminals.
+		SymbolIterator m_nonterminal_start;		//!< The beginning of nonterminals.
+		SymbolIterator m_nonterminal_end;		//!< The end of nonterminals.
+
+		//! Productions grouped by their lhs.
+		std::unordered_map<Rank, PP> m_productions_by_lhs;
+
+		//! Parse a grammar file.
+		/*!
+			The file is read at once and split into lines, and every line into words separated by white space.
+			A line is either a production, lhs followed by its rhs, or starts with '%'.
+			%left, %right, %none and %token declare the precedence and associativity of the following symbols,
+			in increasing precedence line by line, %multi groups multi-terminals sharing the first symbol,
+			and a line starting with '%' otherwise is a comment.
+		*/
+		void read(const std::string&);
+
+		//! Append a production of symbol indices, and renumber all productions.
+		void insert_production(std::size_t lhs, const std::vector<std::size_t>& rhs);
+
+		//! Append rhs to the rhs pool.
+		/*!
+			\return Offset of the first rhs in the pool.
+		*/
+		std::size_t append_rhs(const std::vector<std::size_t>& rhs);
+
+		//! Symbol indices of names, false if any is undefined.
+		bool find_symbols(const std::vector<boost::string_ref>&, std::vector<std::size_t>&) const;
+
+		//! Get a symbol by name while reading, create it if absent.
+		/*!
+			\param name Must outlive reading, i.e. refer to m_text or be a literal.
+			The reference is invalidated by the next call.
+		*/
+		Symbol& intern(boost::string_ref name);
+
+		/// @cond
+		void rearrange_symbols();
+		void rearrange_productions();
+		void compute_lambdas();
+		/// @endcond
+
+	};
+
 }
\ No newline at end of file
@@ -1,48 +1,218 @@
-#include "SymbolSet.h"
-#include "Symbol.h"
-
-#include <cassert>
-
-namespace pitaya {
-
-	SymbolSet::SymbolSet()
-		: m_set {} {}
-
-	std::size_t SymbolSet::size() const {
-		return m_set.size();
-	}
-
-	void SymbolSet::resize(std::size_t n) {
-		m_set.resize(n);
-	}
-
-	bool SymbolSet::add(const Symbol& s) {
-		auto id = s.index();
-		assert(id < size());
-		if (m_set[id]) return false;
-		return m_set[id] = true;
-	}
-
-	bool SymbolSet::union_with(const SymbolSet& s) {
-		assert(size() == s.size());
-		bool changed = false;
-		for (std::size_t i = 0; i < size(); i++) {
-			if (!s.m_set[i]) continue;
-			if (!m_set[i]) {
-				m_set[i] = true;
-				changed = true;
-			}
-		}
-		return changed;
-	}
-
-	bool SymbolSet::operator[](const Symbol& s) const {
-		assert(s.index() < size());
-		return m_set[s.index()];
-	}
-
-	void SymbolSet::clear() {
-		m_set.clear();
-	}
-
+#include "SymbolSet.h"
+#include "Symbol.h"
+
+#include <cassert>
+
+namespace pitaya {
+
+	namespace {
+
+		// number of set bits of a word
+		std::size_t popcount(std::uint64_t w) {
+			w = w - ((w >> 1) & 0x5555555555555555ull);
+			w = (w & 0x3333333333333333ull) + ((w >> 2) & 0x3333333333333333ull);
+			w = (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0full;
+			return std::size_t((w * 0x0101010101010101ull) >> 56);
+		}
+
+		// index of the lowest set bit of a nonzero word
+		std::size_t lowest_bit(std::uint64_t w) {
+			return popcount((w & (~w + 1)) - 1);
+		}
+
+	}
+
+	const std::size_t SymbolRow::npos;
+	const std::size_t SymbolRow::WORD_BITS;
+	const std::size_t SymbolSet::npos;
+
+	std::size_t SymbolRow::words(std::size_t n) {
+		return (n + WORD_BITS - 1) / WORD_BITS;
+	}
+
+	SymbolRow::SymbolRow()
+		: m_words {}, m_size {} {}
+
+	SymbolRow::SymbolRow(Word* words, std::size_t n)
+		: m_words {words}, m_size {n} {}
+
+	std::size_t SymbolRow::size() const {
+		return m_size;
+	}
+
+	bool SymbolRow::add(const Symbol& s) {
+		auto id = s.index();
+		assert(id < size());
+		auto& word = m_words[id / WORD_BITS];
+		auto bit = Word(1) << (id % WORD_BITS);
+		if (word & bit) return false;
+		word |= bit;
+		return true;
+	}
+
+	bool SymbolRow::union_with(const SymbolRow& s) {
+		assert(size() == s.size());
+		Word changed = 0;
+		for (std::size_t i = 0, n = words(m_size); i < n; i++) {
+			changed |= s.m_words[i] & ~m_words[i];
+			m_words[i] |= s.m_words[i];
+		}
+		return changed != 0;
+	}
+
+	bool SymbolRow::intersect_with(const SymbolRow& s) {
+		assert(size() == s.size());
+		Word changed = 0;
+		for (std::size_t i = 0, n = words(m_size); i < n; i++) {
+			changed |= m_words[i] & ~s.m_words[i];
+			m_words[i] &= s.m_words[i];
+		}
+		return changed != 0;
+	}
+
+	bool SymbolRow::subtract(const SymbolRow& s) {
+		assert(size() == s.size());
+		Word changed = 0;
+		for (std::size_t i = 0, n = words(m_size); i < n; i++) {
+			changed |= m_words[i] & s.m_words[i];
+			m_words[i] &= ~s.m_words[i];
+		}
+		return changed != 0;
+	}
+
+	void SymbolRow::clear() {
+		for (std::size_t i = 0, n = words(m_size); i < n; i++) {
+			m_words[i] = 0;
+		}
+	}
+
+	bool SymbolRow::intersects(const SymbolRow& s) const {
+		assert(size() == s.size());
+		for (std::size_t i = 0, n = words(m_size); i < n; i++) {
+			if (m_words[i] & s.m_words[i]) return true;
+		}
+		return false;
+	}
+
+	std::size_t SymbolRow::count() const {
+		std::size_t c = 0;
+		for (std::size_t i = 0, n = words(m_size); i < n; i++) {
+			c += popcount(m_words[i]);
+		}
+		return c;
+	}
+
+	bool SymbolRow::empty() const {
+		return find_from(0) == npos;
+	}
+
+	std::size_t SymbolRow::find_first() const {
+		return find_from(0);
+	}
+
+	std::size_t SymbolRow::find_next(std::size_t index) const {
+		auto next = index + 1;
+		if (next >= m_size) return npos;
+		auto i = next / WORD_BITS;
+		// bits at and after 'next' in its word
+		auto w = m_words[i] & (~Word(0) << (next % WORD_BITS));
+		if (w) {
+			return i * WORD_BITS + lowest_bit(w);
+		}
+		return find_from(i + 1);
+	}
+
+	bool SymbolRow::operator[](const Symbol& s) const {
+		return test(s.index());
+	}
+
+	bool SymbolRow::test(std::size_t index) const {
+		assert(index < size());
+		return (m_words[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+	}
+
+	std::size_t SymbolRow::find_from(std::size_t word) const {
+		for (std::size_t i = word, n = words(m_size); i < n; i++) {
+			if (m_words[i]) {
+				return i * WORD_BITS + lowest_bit(m_words[i]);
+			}
+		}
+		return npos;
+	}
+
+	SymbolSet::SymbolSet()
+		: m_size {}, m_words {} {}
+
+	std::size_t SymbolSet::size() const {
+		return m_size;
+	}
+
+	void SymbolSet::resize(std::size_t n) {
+		const std::size_t bits = sizeof(SymbolRow::Word) * 8;
+		m_words.resize(SymbolRow::words(n), 0);
+		if (n < m_size && n % bits != 0) {
+			// bits beyond the size must stay clear
+			m_words.back() &= (SymbolRow::Word(1) << (n % bits)) - 1;
+		}
+		m_size = n;
+	}
+
+	bool SymbolSet::add(const Symbol& s) {
+		return row().add(s);
+	}
+
+	bool SymbolSet::union_with(const SymbolSet& s) {
+		return row().union_with(s.row());
+	}
+
+	bool SymbolSet::intersect_with(const SymbolSet& s) {
+		return row().intersect_with(s.row());
+	}
+
+	bool SymbolSet::subtract(const SymbolSet& s) {
+		return row().subtract(s.row());
+	}
+
+	bool SymbolSet::intersects(const SymbolSet& s) const {
+		return row().intersects(s.row());
+	}
+
+	std::size_t SymbolSet::count() const {
+		return row().count();
+	}
+
+	bool SymbolSet::empty() const {
+		return row().empty();
+	}
+
+	std::size_t SymbolSet::find_first() const {
+		return row().find_first();
+	}
+
+	std::size_t SymbolSet::find_next(std::size_t index) const {
+		return row().find_next(index);
+	}
+
+	bool SymbolSet::operator[](const Symbol& s) const {
+		return row()[s];
+	}
+
+	bool SymbolSet::test(std::size_t index) const {
+		return row().test(index);
+	}
+
+	void SymbolSet::clear() {
+		m_size = 0;
+		m_words.clear();
+	}
+
+	SymbolRow SymbolSet::row() {
+		return SymbolRow(m_words.data(), m_size);
+	}
+
+	const SymbolRow SymbolSet::row() const {
+		// the view is const, so the words are never written through it
+		return SymbolRow(const_cast<SymbolRow::Word*>(m_words.data()), m_size);
+	}
+
 }
\ No newline at end of file
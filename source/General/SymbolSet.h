@@ -1,53 +1,200 @@
-#pragma once
-
-#include <boost\dynamic_bitset\dynamic_bitset.hpp>
-
-namespace pitaya {
-
-	class Symbol;
-
-	/*!
-		\ingroup General
-		Set of symbols.
-	*/
-	class SymbolSet {
-
-	public:
-
-		//! Default constructor.
-		SymbolSet();
-
-		//! Size of the set.
-		std::size_t size() const;
-
-		//! Change set size.
-		/*!
-			\param n New size.
-		*/
-		void resize(std::size_t n);
-
-		//! Add a symbol.
-		/*!
-			\return False if the symbol is already in the set.
-		*/
-		bool add(const Symbol&);
-
-		//! Union with another set.
-		/*!
-			\return False if this set does not change after union.
-		*/
-		bool union_with(const SymbolSet&);
-
-		//! Whether the symbol is in set.
-		bool operator[](const Symbol&) const;
-
-		//! Clear all symbols.
-		void clear();
-
-	private:
-
-		boost::dynamic_bitset<> m_set;		//!< Underlying set representation.
-
-	};
-
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace pitaya {
+
+	class Symbol;
+
+	/*!
+		\ingroup General
+		View of a set of symbols stored elsewhere, e.g. a row of a bit-matrix.
+
+		A bit per symbol index, stored in 64-bit words so that set operations
+		work a word at a time. The words are not owned by the view.
+	*/
+	class SymbolRow {
+
+	public:
+
+		using Word = std::uint64_t;
+
+		//! Returned by find_first() and find_next() when there are no more symbols.
+		static const std::size_t npos = std::size_t(-1);
+
+		//! Number of words needed by a set of n symbols.
+		static std::size_t words(std::size_t n);
+
+		//! Default constructor, an empty view.
+		SymbolRow();
+
+		//! Constructor.
+		/*!
+			\param words At least words(n) words, bits beyond n must be clear.
+			\param n Size of the set.
+		*/
+		SymbolRow(Word* words, std::size_t n);
+
+		//! Size of the set.
+		std::size_t size() const;
+
+		//! Add a symbol.
+		/*!
+			\return False if the symbol is already in the set.
+		*/
+		bool add(const Symbol&);
+
+		//! Union with another set.
+		/*!
+			\return False if this set does not change after union.
+		*/
+		bool union_with(const SymbolRow&);
+
+		//! Intersection with another set.
+		/*!
+			\return False if this set does not change after intersection.
+		*/
+		bool intersect_with(const SymbolRow&);
+
+		//! Remove all symbols of another set.
+		/*!
+			\return False if this set does not change after subtraction.
+		*/
+		bool subtract(const SymbolRow&);
+
+		//! Remove all symbols, keeping the size.
+		void clear();
+
+		//! Whether the two sets have any symbol in common.
+		bool intersects(const SymbolRow&) const;
+
+		//! Number of symbols in set.
+		std::size_t count() const;
+
+		//! Whether the set has no symbol.
+		bool empty() const;
+
+		//! Index of the first symbol in set.
+		/*!
+			\return npos if the set is empty.
+		*/
+		std::size_t find_first() const;
+
+		//! Index of the first symbol in set after a given index.
+		/*!
+			\return npos if there is none.
+		*/
+		std::size_t find_next(std::size_t index) const;
+
+		//! Whether the symbol is in set.
+		bool operator[](const Symbol&) const;
+
+		//! Whether the symbol of an index is in set.
+		bool test(std::size_t index) const;
+
+	private:
+
+		Word* m_words;			//!< The viewed words.
+		std::size_t m_size;		//!< Number of bits.
+
+		/// @cond
+		static const std::size_t WORD_BITS = 64;
+		std::size_t find_from(std::size_t word) const;
+		/// @endcond
+
+	};
+
+	/*!
+		\ingroup General
+		Set of symbols.
+
+		Owns its words and works through a SymbolRow over them.
+	*/
+	class SymbolSet {
+
+	public:
+
+		//! Returned by find_first() and find_next() when there are no more symbols.
+		static const std::size_t npos = SymbolRow::npos;
+
+		//! Default constructor.
+		SymbolSet();
+
+		//! Size of the set.
+		std::size_t size() const;
+
+		//! Change set size.
+		/*!
+			\param n New size.
+		*/
+		void resize(std::size_t n);
+
+		//! Add a symbol.
+		/*!
+			\return False if the symbol is already in the set.
+		*/
+		bool add(const Symbol&);
+
+		//! Union with another set.
+		/*!
+			\return False if this set does not change after union.
+		*/
+		bool union_with(const SymbolSet&);
+
+		//! Intersection with another set.
+		/*!
+			\return False if this set does not change after intersection.
+		*/
+		bool intersect_with(const SymbolSet&);
+
+		//! Remove all symbols of another set.
+		/*!
+			\return False if this set does not change after subtraction.
+		*/
+		bool subtract(const SymbolSet&);
+
+		//! Whether the two sets have any symbol in common.
+		bool intersects(const SymbolSet&) const;
+
+		//! Number of symbols in set.
+		std::size_t count() const;
+
+		//! Whether the set has no symbol.
+		bool empty() const;
+
+		//! Index of the first symbol in set.
+		/*!
+			\return npos if the set is empty.
+		*/
+		std::size_t find_first() const;
+
+		//! Index of the first symbol in set after a given index.
+		/*!
+			\return npos if there is none.
+		*/
+		std::size_t find_next(std::size_t index) const;
+
+		//! Whether the symbol is in set.
+		bool operator[](const Symbol&) const;
+
+		//! Whether the symbol of an index is in set.
+		bool test(std::size_t index) const;
+
+		//! Clear all symbols.
+		void clear();
+
+		//! View of the set.
+		SymbolRow row();
+
+		//! Read-only view of the set.
+		const SymbolRow row() const;
+
+	private:
+
+		std::size_t m_size;						//!< Number of bits.
+		std::vector<SymbolRow::Word> m_words;	//!< Underlying set representation.
+
+	};
+
 }
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "LexTable.h"
+#include "Grammar.h"
+#include "BinaryIO.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace pitaya {
+
+	const LexTable::Transition LexTable::STOP;
+	const LexTable::Transition LexTable::UNDEFINED;
+	const std::size_t LexTable::WIDTH;
+
+	LexTable::LexTable(Grammar& grammar, const StateBuilder& builder)
+		: m_transitions {}, m_tokens {}, m_start {},
+		m_names {}, m_precedences {}, m_keywords {} {
+		for (auto it = grammar.symbol_begin(); it != grammar.symbol_end(); it++) {
+			auto& symbol = *it;
+			m_names.emplace_back(symbol.name());
+			m_precedences.push_back(symbol.precedence());
+			if (symbol.is_token() && symbol != grammar.endmark()) {
+				m_keywords.emplace(symbol.name(), symbol.index());
+			}
+		}
+
+		// assign rows
+		// the initial state has the smallest id
+		std::unordered_map<State::ID, Row> rows;
+		for (auto& p : builder.m_sorted) {
+			rows.emplace(p.first, Row(rows.size()));
+		}
+		m_start = 0;
+
+		// symbols of all byte values, nullptr if undefined
+		std::vector<Symbol*> symbols(WIDTH, nullptr);
+		for (std::size_t c = 0; c < WIDTH; c++) {
+			auto& symbol = grammar.get_symbol(std::string(1, char(c)));
+			if (symbol != grammar.endmark()) {
+				symbols[c] = &symbol;
+			}
+		}
+
+		// fill tables
+		m_transitions.resize(rows.size() * WIDTH, STOP);
+		for (auto& p : builder.m_sorted) {
+			auto& state = *p.second;
+			auto row = rows.at(p.first);
+			m_tokens.push_back(state.is_final() ? state.token_index() : 0);
+			for (std::size_t c = 0; c < WIDTH; c++) {
+				auto& entry = m_transitions[row * WIDTH + c];
+				// whitespace characters always end a token
+				if (isspace(int(c))) continue;
+				auto symbol = symbols[c];
+				if (symbol == nullptr) {
+					entry = UNDEFINED;
+					continue;
+				}
+				State::ID to;
+				if (state.transit(*symbol, to)) {
+					entry = Transition(rows.at(to));
+				}
+				else if (symbol->type() == SymbolType::MULTITERMINAL
+					&& state.transit(symbol->shared_terminal(), to)) {
+					// fallback
+					entry = Transition(rows.at(to));
+				}
+			}
+		}
+	}
+
+	LexTable::LexTable()
+		: m_transitions {}, m_tokens {}, m_start {},
+		m_names {}, m_precedences {}, m_keywords {} {}
+
+	std::unique_ptr<LexTable> LexTable::load(std::istream& is) {
+		BinaryReader reader {is};
+		std::unique_ptr<LexTable> table {new LexTable {}};
+		if (!reader.header("LEXT")) return nullptr;
+		table->m_start = reader.word();
+		table->m_transitions = reader.words<Transition>();
+		table->m_tokens = reader.words<std::size_t>();
+		table->m_names = reader.strings();
+		table->m_precedences = reader.words<int>();
+		auto keywords = reader.words<std::size_t>();
+		if (!reader.good()) return nullptr;
+
+		// check the table is consistent before trusting any index
+		auto rows = table->m_tokens.size();
+		auto symbols = table->m_names.size();
+		if (table->m_transitions.size() != rows * WIDTH || table->m_start >= rows
+			|| table->m_precedences.size() != symbols) {
+			return nullptr;
+		}
+		for (auto t : table->m_transitions) {
+			if (t != STOP && t != UNDEFINED && (t < 0 || std::size_t(t) >= rows)) return nullptr;
+		}
+		for (auto token : table->m_tokens) {
+			if (token >= symbols) return nullptr;
+		}
+		for (auto k : keywords) {
+			if (k >= symbols) return nullptr;
+			table->m_keywords.emplace(table->m_names[k], k);
+		}
+		return table;
+	}
+
+	bool LexTable::save(std::ostream& os) const {
+		BinaryWriter writer {os};
+		writer.header("LEXT");
+		writer.word(m_start);
+		writer.words(m_transitions);
+		writer.words(m_tokens);
+		writer.strings(m_names);
+		writer.words(m_precedences);
+		std::vector<std::size_t> keywords;
+		for (auto& k : m_keywords) {
+			keywords.push_back(k.second);
+		}
+		std::sort(keywords.begin(), keywords.end());		// keep the output stable
+		writer.words(keywords);
+		return writer.good();
+	}
+
+	std::size_t LexTable::state_count() const {
+		return m_tokens.size();
+	}
+
+	LexTable::Row LexTable::start() const {
+		return m_start;
+	}
+
+	LexTable::Transition LexTable::transit(Row row, unsigned char c) const {
+		return m_transitions[row * WIDTH + c];
+	}
+
+	std::size_t LexTable::token_index(Row row) const {
+		return m_tokens[row];
+	}
+
+	std::size_t LexTable::resolve(std::size_t index, const std::string& lexeme) const {
+		auto find = m_keywords.find(lexeme);
+		if (find != m_keywords.end() && m_precedences[find->second] > m_precedences[index]) {
+			return find->second;
+		}
+		return index;
+	}
+
+	std::size_t LexTable::symbol_count() const {
+		return m_names.size();
+	}
+
+	const std::string& LexTable::name(std::size_t index) const {
+		return m_names[index];
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "StateBuilder.h"
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+namespace pitaya {
+
+	/*!
+		\ingroup LA
+		LexTable class.
+
+		DFA compiled from the states of a built StateBuilder.
+		States are renumbered into consecutive rows, each row holds one transition per byte value
+		with the multi-terminal fallback already folded in, so scanning a byte is a single array load.
+	*/
+	class LexTable {
+
+	public:
+
+		friend class CodeGenerator;
+
+		using Row = std::uint32_t;
+		using Transition = std::int32_t;
+
+		//! No transition on this byte, the current token ends here.
+		static const Transition STOP = -1;
+		//! The byte is not a symbol of the grammar.
+		static const Transition UNDEFINED = -2;
+
+		//! Constructor.
+		/*!
+			\param builder A builder whose states have been built.
+		*/
+		LexTable(Grammar&, const StateBuilder& builder);
+
+		//! Load a table written by save().
+		/*!
+			Neither a grammar nor a builder is needed.
+			\return nullptr if the data is malformed or of another format version.
+		*/
+		static std::unique_ptr<LexTable> load(std::istream&);
+
+		//! Write the table in binary form.
+		/*!
+			\return Whether everything has been written.
+		*/
+		bool save(std::ostream&) const;
+
+		//! Number of rows(states).
+		std::size_t state_count() const;
+
+		//! Row of the initial state.
+		Row start() const;
+
+		//! Transition of a row on a byte.
+		/*!
+			\return Row of the destination state, or STOP, or UNDEFINED.
+		*/
+		Transition transit(Row, unsigned char) const;
+
+		//! Token index of a row, 0 if it is not a final state.
+		std::size_t token_index(Row) const;
+
+		//! Decide the token type of a lexeme.
+		/*!
+			A token symbol spelled exactly as the lexeme(e.g. a key-word)
+			overrides the recognized one if it has a higher precedence.
+			\param index Token index of the final state the lexeme ends in.
+			\return Index of the token symbol.
+		*/
+		std::size_t resolve(std::size_t index, const std::string& lexeme) const;
+
+		//! Number of symbols.
+		std::size_t symbol_count() const;
+
+		//! Name of a symbol.
+		const std::string& name(std::size_t index) const;
+
+	private:
+
+		std::vector<Transition> m_transitions;	//!< Transition table, 256 columns per row.
+		std::vector<std::size_t> m_tokens;		//!< Token indices of rows.
+		Row m_start;							//!< Row of the initial state.
+
+		std::vector<std::string> m_names;		//!< Names of symbols.
+		std::vector<int> m_precedences;			//!< Precedences of symbols.
+		std::unordered_map<std::string, std::size_t> m_keywords;	//!< Token symbol indices by name.
+
+		/// @cond
+		static const std::size_t WIDTH = 256;
+		LexTable();
+		/// @endcond
+
+	};
+
+}
\ No newline at end of file
@@ -1,205 +1,351 @@
-#include "StateBuilder.h"
-#include "Grammar.h"
-
-#include <cassert>
-#include <algorithm>
-#include <fstream>
-#include <iostream>
-#include <iomanip>
-#include <regex>
-
-namespace pitaya {
-
-	StateBuilder::StateBuilder(Grammar& grammar)
-		: m_grammar {grammar}, m_states {}, m_sorted {}, m_curr_state {} {}
-
-	void StateBuilder::build() {
-		// initial state
-		m_curr_state.reset();
-		// assume the start symbol is the lhs of the start production
-		m_curr_state.add_base(m_grammar.get_production(0)[0], 0);
-		build_state();
-		decide_token_type();
-	}
-
-	const State& StateBuilder::build_state() {
-		m_curr_state.sort();		// sort basis for hashing and comparing
-		auto& find = m_states.find(m_curr_state);
-		if (find != m_states.end()) {
-			// a state with the same basis already exists
-			m_curr_state.reset();
-			return *find;
-		}
-		// a new state
-		// compute closure before moving
-		m_curr_state.compute_closure(m_grammar);
-		// 'move' the currently building state into the new state
-		auto& new_item = m_states.emplace(std::move(m_curr_state)).first;
-		// compute successors
-		build_successors(*new_item);
-		return *new_item;
-	}
-
-	void StateBuilder::build_successors(const State& state) {
-		bool has_transition = false;
-		// for every symbol(include multi-terminal)
-		for (auto it = m_grammar.symbol_begin(); it != m_grammar.symbol_end(); it++) {
-			has_transition = false;
-			auto& symbol = **it;
-			if (symbol.type() == SymbolType::NONTERMINAL) continue;
-			// for every item in the closure
-			for (auto& item : state.m_closure) {
-				// item: <symbol_index, token_index>
-				auto& left = m_grammar.get_symbol(item.first);
-				if (left.type() != SymbolType::NONTERMINAL) continue;
-				auto range = m_grammar.productions_by_lhs(left);
-				for (auto pid = range.first; pid <= range.second; pid++) {
-					auto& p = m_grammar.get_production(pid);
-					if (p.rhs_count() == 0) continue;
-					if (p[1] != symbol) continue;
-					has_transition = true;
-					/*
-					if (p.rhs_count() == 1) {
-						// A -> a, transit to a final state
-						m_curr_state.is_final() = true;
-						m_curr_state.add_base(symbol, item.second);
-						m_curr_state.m_final_index = symbol.index();
-					}
-					else {
-						// A -> aB
-						if (p[2].type() == SymbolType::NONTERMINAL) {
-							m_curr_state.add_base(p[2], item.second);
-						}
-					}
-					*/
-					// FIXME so tricky
-					// A -> aB
-					if (p.rhs_count() == 2 && p[2].type() == SymbolType::NONTERMINAL) {
-						m_curr_state.add_base(p[2], item.second);
-					}
-					// assert all left productions have the form A -> a[b...x]
-					else {
-						m_curr_state.add_base(p[1], item.second);
-						const State* p_state = &m_curr_state;
-						auto p_symbol = &p[1];
-						std::string name(p[1].name());		// name = "a"
-						// from b to x
-						for (size_t i = 1; i < p.rhs_count(); i++) {
-							name += p[i + 1].name();
-							p_symbol = &m_grammar.get_symbol(name);
-							State tmp {};
-							tmp.add_base(*p_symbol, item.second);
-							tmp.m_closure.emplace(p_symbol->index(), item.second);
-							auto& ns = *m_states.emplace(std::move(tmp)).first;
-							p_state->add_transition(p[i + 1], ns);
-							p_state = &ns;
-						}
-						p_state->m_is_final = true;
-						p_state->m_final_index = p_symbol->index();
-					}
-				}
-			}
-			if (has_transition && m_curr_state.m_basis.size() > 0) {
-				auto& new_state = build_state();
-				state.add_transition(symbol, new_state);
-			}
-		}
-	}
-
-	void StateBuilder::decide_token_type() {
-		for (auto& state : m_states) {
-			m_sorted.emplace(state.m_id, &state);
-			if (!state.is_final()) continue;
-			for (auto& item : state.m_closure) {
-				if (state.m_final_index == item.first) {
-					state.m_token_index = item.second;
-					break;
-				}
-			}
-		}
-	}
-
-	const State& StateBuilder::get_state(State::ID id) const {
-		return *m_sorted.at(id);
-	}
-
-	void StateBuilder::report(bool graph) const {
-		std::ofstream file, gfile;
-		file.open("report\\lexical_states", std::ios::trunc);
-		if (graph) {
-			gfile.open("report\\graph\\lexical.dot", std::ios::trunc);
-		}
-		if (file.is_open()) {
-			if (gfile.is_open()) {
-				gfile << "digraph lexical_graph {\n" << "node [shape=record];\n";
-			}
-			for (auto& p : m_sorted) {
-				auto& state = *p.second;
-				file << "[state " << state.m_id << "]";
-				if (state.is_final()) {
-					file << " FIN> " << m_grammar.get_symbol(state.token_index());
-				}
-				file << '\n';
-
-				auto cols = 3, col = 0;
-				std::string gitems;
-				for (auto& item : state.m_closure) {
-					std::string items;
-					std::string first(m_grammar.get_symbol(item.first).name());
-					std::string second(m_grammar.get_symbol(item.second).name());
-					items.append("( ").append(first)
-						.append("  ").append(second)
-						.append(" )");
-					file << std::setw(40) << std::left << items;
-					if (++col == cols) {
-						col = 0;
-						file << '\n';
-					}
-
-					std::regex re("[|<>{}]");
-					first = std::regex_replace(first, re, "\\$&");
-					second = std::regex_replace(second, re, "\\$&");
-					gitems.append("{ ").append(first)
-						.append(" | ").append(second)
-						.append(" }|");
-				}
-				if (col != 0) {
-					file << '\n';
-				}
-				if (gfile.is_open()) {
-					if (gitems.size() > 0) {
-						// remove the last '|'
-						gitems.erase(gitems.size() - 1);
-					}
-					gfile << state.m_id << " [label=\"" << state.m_id << "|{"
-						<< gitems << "}\"";
-					if (state.is_final()) {
-						gfile << ", style=bold";
-					}
-					gfile << "];\n";
-				}
-
-				State::ID to;
-				for (auto it = m_grammar.symbol_begin(); it != m_grammar.symbol_end(); it++) {
-					if (state.transit(**it, to)) {
-						file << ">\t" << std::setw(20)
-							<< **it << "-->\t" << to << '\n';
-						if (gfile.is_open()) {
-							gfile << state.m_id << " -> " << to
-								<< " [label=\"" << **it << "\"];\n";
-						}
-					}
-				}
-				file << '\n';
-			}
-			if (gfile.is_open()) {
-				gfile << "}\n";
-			}
-		}
-		file.close();
-		if (graph) {
-			gfile.close();
-		}
-	}
-
+#include "StateBuilder.h"
+#include "Grammar.h"
+
+#include <cassert>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <regex>
+
+namespace pitaya {
+
+	StateBuilder::StateBuilder(Grammar& grammar)
+		: m_grammar {grammar}, m_states {}, m_sorted {}, m_worklist {},
+		m_built_count {} {}
+
+	void StateBuilder::build() {
+		// initial state
+		State initial {};
+		// assume the start symbol is the lhs of the start production
+		initial.add_base(m_grammar.get_production(0)[0], 0);
+		build_state(std::move(initial));
+		while (!m_worklist.empty()) {
+			auto& state = *m_worklist.front();
+			m_worklist.pop_front();
+			build_successors(state);
+		}
+		decide_token_type();
+		minimize();
+	}
+
+	const State& StateBuilder::build_state(State&& state) {
+		state.sort();		// sort basis for hashing and comparing
+		auto& find = m_states.find(state);
+		if (find != m_states.end()) {
+			// a state with the same basis already exists
+			return *find;
+		}
+		// a new state, ids start from 1
+		state.m_id = m_states.size() + 1;
+		state.compute_closure(m_grammar);
+		auto& new_state = *m_states.emplace(std::move(state)).first;
+		m_worklist.push_back(&new_state);
+		return new_state;
+	}
+
+	void StateBuilder::build_successors(const State& state) {
+		State next {};
+		bool has_transition = false;
+		// for every symbol(include multi-terminal)
+		for (auto it = m_grammar.symbol_begin(); it != m_grammar.symbol_end(); it++) {
+			has_transition = false;
+			auto& symbol = *it;
+			if (symbol.type() == SymbolType::NONTERMINAL) continue;
+			// for every item in the closure
+			for (auto& item : state.m_closure) {
+				// item: <symbol_index, token_index>
+				auto& left = m_grammar.get_symbol(item.first);
+				if (left.type() != SymbolType::NONTERMINAL) continue;
+				auto range = m_grammar.productions_by_lhs(left);
+				for (auto pid = range.first; pid <= range.second; pid++) {
+					auto& p = m_grammar.get_production(pid);
+					if (p.rhs_count() == 0) continue;
+					if (p[1] != symbol) continue;
+					has_transition = true;
+					/*
+					if (p.rhs_count() == 1) {
+						// A -> a, transit to a final state
+						next.is_final() = true;
+						next.add_base(symbol, item.second);
+						next.m_final_index = symbol.index();
+					}
+					else {
+						// A -> aB
+						if (p[2].type() == SymbolType::NONTERMINAL) {
+							next.add_base(p[2], item.second);
+						}
+					}
+					*/
+					// FIXME so tricky
+					// A -> aB
+					if (p.rhs_count() == 2 && p[2].type() == SymbolType::NONTERMINAL) {
+						next.add_base(p[2], item.second);
+					}
+					// assert all left productions have the form A -> a[b...x]
+					else {
+						next.add_base(p[1], item.second);
+						const State* p_state = &next;
+						auto p_symbol = &p[1];
+						std::string name(p[1].name());		// name = "a"
+						// from b to x
+						for (size_t i = 1; i < p.rhs_count(); i++) {
+							name += p[i + 1].name();
+							p_symbol = &m_grammar.get_symbol(name);
+							State tmp {};
+							tmp.m_id = m_states.size() + 1;
+							tmp.add_base(*p_symbol, item.second);
+							tmp.m_closure.emplace(p_symbol->index(), item.second);
+							auto& ns = *m_states.emplace(std::move(tmp)).first;
+							p_state->add_transition(p[i + 1], ns);
+							p_state = &ns;
+						}
+						p_state->m_is_final = true;
+						p_state->m_final_index = p_symbol->index();
+					}
+				}
+			}
+			if (has_transition && next.m_basis.size() > 0) {
+				auto& new_state = build_state(std::move(next));
+				state.add_transition(symbol, new_state);
+				next.reset();
+			}
+		}
+	}
+
+	void StateBuilder::decide_token_type() {
+		for (auto& state : m_states) {
+			m_sorted.emplace(state.m_id, &state);
+			if (!state.is_final()) continue;
+			for (auto& item : state.m_closure) {
+				if (state.m_final_index == item.first) {
+					state.m_token_index = item.second;
+					break;
+				}
+			}
+		}
+	}
+
+	void StateBuilder::minimize() {
+		m_built_count = m_sorted.size();
+
+		// index states, the last one is a dead state standing for missing transitions
+		std::vector<const State*> states;
+		std::unordered_map<State::ID, std::size_t> indices;
+		for (auto& p : m_sorted) {
+			indices.emplace(p.first, states.size());
+			states.push_back(p.second);
+		}
+		auto n = states.size();
+		auto dead = n;
+
+		// input symbols
+		std::vector<Symbol*> inputs;
+		for (auto it = m_grammar.symbol_begin(); it != m_grammar.symbol_end(); it++) {
+			if (it->type() != SymbolType::NONTERMINAL) {
+				inputs.push_back(&*it);
+			}
+		}
+		auto k = inputs.size();
+
+		// inverse of the transitions taken by the tokenizer
+		// inverse[a * (n + 1) + t] = all states reaching t on input a
+		std::vector<std::vector<std::size_t>> inverse((n + 1) * k);
+		for (std::size_t s = 0; s <= n; s++) {
+			for (std::size_t a = 0; a < k; a++) {
+				auto t = dead;
+				State::ID to;
+				if (s != dead) {
+					auto& symbol = *inputs[a];
+					if (states[s]->transit(symbol, to)) {
+						t = indices.at(to);
+					}
+					else if (symbol.type() == SymbolType::MULTITERMINAL
+						&& states[s]->transit(symbol.shared_terminal(), to)) {
+						// fallback
+						t = indices.at(to);
+					}
+				}
+				inverse[a * (n + 1) + t].push_back(s);
+			}
+		}
+
+		// initial partition by token index, the dead state alone
+		std::vector<std::vector<std::size_t>> blocks;
+		std::vector<std::size_t> block_of(n + 1);
+		std::map<std::size_t, std::size_t> by_token;
+		for (std::size_t s = 0; s < n; s++) {
+			auto token = states[s]->is_final() ? states[s]->token_index() + 1 : 0;
+			auto res = by_token.emplace(token, blocks.size());
+			if (res.second) {
+				blocks.emplace_back();
+			}
+			block_of[s] = res.first->second;
+			blocks[block_of[s]].push_back(s);
+		}
+		block_of[dead] = blocks.size();
+		blocks.emplace_back(1, dead);
+
+		// refine
+		std::vector<std::size_t> worklist;
+		std::vector<bool> queued(blocks.size(), true);
+		for (std::size_t b = 0; b < blocks.size(); b++) {
+			worklist.push_back(b);
+		}
+		std::vector<bool> marked(n + 1, false);
+		std::vector<std::size_t> touched;
+		while (!worklist.empty()) {
+			auto splitter = blocks[worklist.back()];
+			queued[worklist.back()] = false;
+			worklist.pop_back();
+			for (std::size_t a = 0; a < k; a++) {
+				// mark all predecessors of the splitter on input a
+				touched.clear();
+				for (auto t : splitter) {
+					for (auto s : inverse[a * (n + 1) + t]) {
+						if (marked[s]) continue;
+						marked[s] = true;
+						touched.push_back(block_of[s]);
+					}
+				}
+				std::sort(touched.begin(), touched.end());
+				touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+				// split every block partly marked
+				for (auto b : touched) {
+					std::vector<std::size_t> in, out;
+					for (auto s : blocks[b]) {
+						(marked[s] ? in : out).push_back(s);
+					}
+					if (out.empty()) continue;
+					auto nb = blocks.size();
+					blocks[b] = std::move(in);
+					blocks.push_back(std::move(out));
+					queued.push_back(false);
+					for (auto s : blocks[nb]) {
+						block_of[s] = nb;
+					}
+					if (queued[b] || blocks[nb].size() <= blocks[b].size()) {
+						queued[nb] = true;
+						worklist.push_back(nb);
+					}
+					else {
+						queued[b] = true;
+						worklist.push_back(b);
+					}
+				}
+				for (auto t : splitter) {
+					for (auto s : inverse[a * (n + 1) + t]) {
+						marked[s] = false;
+					}
+				}
+			}
+		}
+
+		// representatives have the smallest ids, so the initial state is kept
+		std::vector<State::ID> representatives(blocks.size());
+		for (std::size_t b = 0; b < blocks.size(); b++) {
+			auto s = *std::min_element(blocks[b].begin(), blocks[b].end());
+			if (s != dead) {
+				representatives[b] = states[s]->id();
+			}
+		}
+		for (std::size_t s = 0; s < n; s++) {
+			auto& state = *states[s];
+			if (representatives[block_of[s]] == state.id()) {
+				for (auto& transition : state.m_transitions) {
+					transition.second = representatives[block_of[indices.at(transition.second)]];
+				}
+			}
+			else {
+				m_sorted.erase(state.id());
+				m_states.erase(m_states.find(state));
+			}
+		}
+	}
+
+	const State& StateBuilder::get_state(State::ID id) const {
+		return *m_sorted.at(id);
+	}
+
+	void StateBuilder::report(bool graph) const {
+		std::ofstream file, gfile;
+		file.open("report\\lexical_states", std::ios::trunc);
+		if (graph) {
+			gfile.open("report\\graph\\lexical.dot", std::ios::trunc);
+		}
+		if (file.is_open()) {
+			if (gfile.is_open()) {
+				gfile << "digraph lexical_graph {\n" << "node [shape=record];\n";
+			}
+			file << "states: " << m_sorted.size()
+				<< " (" << m_built_count << " before minimization)\n\n";
+			for (auto& p : m_sorted) {
+				auto& state = *p.second;
+				file << "[state " << state.m_id << "]";
+				if (state.is_final()) {
+					file << " FIN> " << m_grammar.get_symbol(state.token_index());
+				}
+				file << '\n';
+
+				auto cols = 3, col = 0;
+				std::string gitems;
+				for (auto& item : state.m_closure) {
+					std::string items;
+					std::string first(m_grammar.get_symbol(item.first).name());
+					std::string second(m_grammar.get_symbol(item.second).name());
+					items.append("( ").append(first)
+						.append("  ").append(second)
+						.append(" )");
+					file << std::setw(40) << std::left << items;
+					if (++col == cols) {
+						col = 0;
+						file << '\n';
+					}
+
+					std::regex re("[|<>{}]");
+					first = std::regex_replace(first, re, "\\$&");
+					second = std::regex_replace(second, re, "\\$&");
+					gitems.append("{ ").append(first)
+						.append(" | ").append(second)
+						.append(" }|");
+				}
+				if (col != 0) {
+					file << '\n';
+				}
+				if (gfile.is_open()) {
+					if (gitems.size() > 0) {
+						// remove the last '|'
+						gitems.erase(gitems.size() - 1);
+					}
+					gfile << state.m_id << " [label=\"" << state.m_id << "|{"
+						<< gitems << "}\"";
+					if (state.is_final()) {
+						gfile << ", style=bold";
+					}
+					gfile << "];\n";
+				}
+
+				State::ID to;
+				for (auto it = m_grammar.symbol_begin(); it != m_grammar.symbol_end(); it++) {
+					if (state.transit(*it, to)) {
+						file << ">\t" << std::setw(20)
+							<< *it << "-->\t" << to << '\n';
+						if (gfile.is_open()) {
+							gfile << state.m_id << " -> " << to
+								<< " [label=\"" << *it << "\"];\n";
+						}
+					}
+				}
+				file << '\n';
+			}
+			if (gfile.is_open()) {
+				gfile << "}\n";
+			}
+		}
+		file.close();
+		if (graph) {
+			gfile.close();
+		}
+	}
+
 }
\ No newline at end of file
@@ -1,51 +1,71 @@
-#pragma once
-
-#include "State.h"
-
-#include <unordered_set>
-#include <map>
-
-#include <boost\functional\hash\hash.hpp>
-
-namespace pitaya {
-
-	/*!
-		\ingroup LA
-		StateBuilder class.
-	*/
-	class StateBuilder {
-
-	public:
-
-		//! Constructor.
-		StateBuilder(Grammar&);
-
-		//! Build all states.
-		void build();
-
-		//! Get a state by id.
-		const State& get_state(State::ID) const;
-
-		//! Generate report file.
-		void report(bool graph) const;
-
-	private:
-
-		Grammar& m_grammar;		//!< The grammar this builder works on.
-
-		std::unordered_set<State, boost::hash<State>> m_states;	//!< All states.
-		std::map<State::ID, const State*> m_sorted;		//!< Sorted states for quick access.
-		State m_curr_state;		//!< The State being built currently.
-
-		//! Build a state according to m_curr_state.
-		const State& build_state();
-
-		//! Build all successors of an state.
-		void build_successors(const State&);
-
-		//! Decide token type for all final states.
-		void decide_token_type();
-
-	};
-
+#pragma once
+
+#include "State.h"
+
+#include <deque>
+#include <unordered_set>
+#include <map>
+
+#include <boost\functional\hash\hash.hpp>
+
+namespace pitaya {
+
+	/*!
+		\ingroup LA
+		StateBuilder class.
+	*/
+	class StateBuilder {
+
+	public:
+
+		friend class LexTable;
+
+		//! Constructor.
+		StateBuilder(Grammar&);
+
+		//! Build all states.
+		/*!
+			States are built breadth first from a worklist,
+			so they are numbered by their distance from the initial state.
+		*/
+		void build();
+
+		//! Get a state by id.
+		const State& get_state(State::ID) const;
+
+		//! Generate report file.
+		void report(bool graph) const;
+
+	private:
+
+		Grammar& m_grammar;		//!< The grammar this builder works on.
+
+		std::unordered_set<State, boost::hash<State>> m_states;	//!< All states.
+		std::map<State::ID, const State*> m_sorted;		//!< Sorted states for quick access.
+		std::deque<const State*> m_worklist;	//!< States whose successors are not built yet.
+		std::size_t m_built_count;	//!< Number of states before minimization.
+
+		//! Find the state with the same basis, or add it as a new one.
+		/*!
+			A new state gets the next id and its closure, and is queued in m_worklist.
+		*/
+		const State& build_state(State&&);
+
+		//! Build all successors of an state.
+		void build_successors(const State&);
+
+		//! Decide token type for all final states.
+		void decide_token_type();
+
+		//! Merge equivalent states.
+		/*!
+			Hopcroft's algorithm on the transitions the tokenizer actually takes,
+			i.e. with the multi-terminal fallback applied.
+			Final states are only merged if they have the same token index,
+			and a merged class is represented by its state of the smallest id.
+		*/
+		void minimize();
+
+	};
+
 }
\ No newline at end of file
@@ -1,128 +1,265 @@
-#include "Tokenizer.h"
-#include "Grammar.h"
-
-#include <cctype>
-#include <cassert>
-#include <fstream>
-#include <iostream>
-#include <iomanip>
-
-namespace pitaya {
-
-	Tokenizer::Tokenizer(Grammar& grammar, StateBuilder& builder)
-		: m_grammar {grammar}, m_builder {builder}, m_tokens {},
-		m_current {}, m_curr_line {1} {}
-
-	Tokenizer::ParseResult Tokenizer::parse(std::ifstream& file) {
-		while (file.peek() != std::ifstream::traits_type::eof()) {
-			// eat whitespace characters
-			while (isspace(file.peek())) {
-				if (file.peek() == '\n') {
-					m_curr_line++;
-				}
-				file.get();
-			}
-			if (file.peek() != std::ifstream::traits_type::eof()) {
-				// restart
-				auto state = &m_builder.get_state(1);
-				char input = file.peek();
-				auto symbol = &m_grammar.get_symbol(std::string(1, input));
-				if (*symbol == m_grammar.endmark()) {
-					// error: undefined symbol
-					return ParseResult {false, m_curr_line, input};
-				}
-				if (!state->transit(*symbol)) {
-					// fallback
-					if (symbol->type() == SymbolType::MULTITERMINAL) {
-						symbol = &symbol->shared_terminal();
-					}
-				}
-				auto start_pos = file.tellg();
-				auto parse_pos = start_pos;
-				auto last_final_pos = parse_pos;
-				State::ID next_state = 0, last_final = 0;
-				if (state->is_final()) {
-					last_final = state->id();
-				}
-				while (state->transit(*symbol, next_state)) {
-					state = &m_builder.get_state(next_state);
-					if (state->is_final()) {
-						last_final = state->id();
-						last_final_pos = parse_pos;
-					}
-					// next symbol
-					parse_pos += 1;
-					file.seekg(parse_pos);
-					if (file.peek() == std::ifstream::traits_type::eof() || isspace(file.peek())) {
-						break;
-					}
-					input = file.peek();
-					symbol = &m_grammar.get_symbol(std::string(1, input));
-					if (*symbol == m_grammar.endmark()) {
-						// error: undefined symbol
-						return ParseResult {false, m_curr_line, input};
-					}
-					if (!state->transit(*symbol)) {
-						// fallback
-						if (symbol->type() == SymbolType::MULTITERMINAL) {
-							symbol = &symbol->shared_terminal();
-						}
-					}
-				}
-				if (last_final == 0) {
-					// err: not in a final state
-					return ParseResult {false, m_curr_line, input};
-				}
-				else {
-					// recognize a token
-					m_tokens.emplace_back();
-					auto& new_token = m_tokens.back();
-					file.seekg(start_pos);
-					while (file.tellg() <= last_final_pos) {
-						new_token.value.append(1, char(file.get()));
-					}
-					auto index = m_builder.get_state(last_final).token_index();
-					auto& self = m_grammar.get_symbol(new_token.value);
-					// check token precedence(e.g. key-words)
-					if (self != m_grammar.endmark() && self.is_token()) {
-						if (self.precedence() > m_grammar.get_symbol(index).precedence()) {
-							index = self.index();
-						}
-					}
-					assert(index != 0);		// token must be defined
-					new_token.type = pool().emplace(m_grammar.get_symbol(index).name()).first->c_str();
-				}
-			}
-		}
-		return ParseResult {true};
-	}
-
-	const Token& Tokenizer::next() {
-		return m_tokens[m_current++];
-	}
-
-	const Token& Tokenizer::peek() {
-		return m_tokens[m_current];
-	}
-
-	bool Tokenizer::has_next() const {
-		return m_current < m_tokens.size();
-	}
-
-	void Tokenizer::report() const {
-		std::ofstream file;
-		file.open("report\\token_stream", std::ios::trunc);
-		auto cols = 5, col = 0;
-		for (auto& token : m_tokens) {
-			std::string t(token.type);
-			t.insert(0, "( ").append("  ").append(token.value).append(" )");
-			file << std::setw(30) << std::left << t;
-			if (++col == cols) {
-				col = 0;
-				file << '\n';
-			}
-		}
-		file.close();
-	}
-
+#include "Tokenizer.h"
+#include "Grammar.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+
+namespace pitaya {
+
+	Tokenizer::Tokenizer(Grammar& grammar, StateBuilder& builder)
+		: m_grammar {&grammar}, m_builder {&builder}, m_table {nullptr}, m_type_names {},
+		m_stream {nullptr}, m_chunk {}, m_source {}, m_data {}, m_base {}, m_end {}, m_pos {},
+		m_lexeme {}, m_tokens {}, m_current {}, m_curr_line {1}, m_result {true, 0, 0} {
+		for (auto it = grammar.symbol_begin(); it != grammar.symbol_end(); it++) {
+			m_type_names.emplace_back(it->name());
+		}
+	}
+
+	Tokenizer::Tokenizer(const LexTable& table)
+		: m_grammar {nullptr}, m_builder {nullptr}, m_table {&table}, m_type_names {},
+		m_stream {nullptr}, m_chunk {}, m_source {}, m_data {}, m_base {}, m_end {}, m_pos {},
+		m_lexeme {}, m_tokens {}, m_current {}, m_curr_line {1}, m_result {true, 0, 0} {
+		for (std::size_t i = 0; i < table.symbol_count(); i++) {
+			m_type_names.push_back(table.name(i));
+		}
+	}
+
+	Tokenizer::ParseResult Tokenizer::parse(std::ifstream& file) {
+		// read the whole file at once, then scan the buffer
+		m_source.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		return parse(m_source.data(), m_source.size());
+	}
+
+	Tokenizer::ParseResult Tokenizer::parse(const char* data, std::size_t size) {
+		m_stream = nullptr;
+		m_data = data;
+		m_base = 0;
+		m_end = size;
+		m_pos = 0;
+		while (lex()) {}
+		return m_result;
+	}
+
+	void Tokenizer::open(std::istream& stream, std::size_t chunk) {
+		m_stream = &stream;
+		m_chunk = chunk;
+		m_source.clear();
+		m_data = m_source.data();
+		m_base = m_end = m_pos = 0;
+		m_tokens.clear();
+		m_current = 0;
+		m_curr_line = 1;
+		m_result = ParseResult {true, 0, 0};
+	}
+
+	const Tokenizer::ParseResult& Tokenizer::result() const {
+		return m_result;
+	}
+
+	bool Tokenizer::lex() {
+		if (!m_result.success) {
+			return false;
+		}
+		// eat whitespace characters
+		char input;
+		while (true) {
+			if (m_pos == m_end && !refill(m_pos)) {
+				return false;
+			}
+			input = m_data[m_pos - m_base];
+			if (!isspace(static_cast<unsigned char>(input))) {
+				break;
+			}
+			if (input == '\n') {
+				m_curr_line++;
+			}
+			m_pos++;
+		}
+
+		// restart
+		auto start_pos = m_pos;
+		auto parse_pos = start_pos;
+		auto last_final_pos = parse_pos;
+		std::size_t index = 0;		// token index of the last final state
+		if (m_table) {
+			auto& table = *m_table;
+			auto row = table.start();
+			auto next = table.transit(row, static_cast<unsigned char>(input));
+			index = table.token_index(row);
+			// whitespace characters yield STOP, so the end of a token is found
+			// without testing each byte against isspace()
+			while (next >= 0) {
+				row = LexTable::Row(next);
+				if (table.token_index(row) != 0) {
+					index = table.token_index(row);
+					last_final_pos = parse_pos;
+				}
+				// next byte
+				if (++parse_pos == m_end && !refill(start_pos)) {
+					break;
+				}
+				input = m_data[parse_pos - m_base];
+				next = table.transit(row, static_cast<unsigned char>(input));
+			}
+			if (next == LexTable::UNDEFINED) {
+				// error: undefined symbol
+				m_result = ParseResult {false, m_curr_line, input};
+				return false;
+			}
+		}
+		else {
+			auto state = &m_builder->get_state(1);
+			auto symbol = &m_grammar->get_symbol(std::string(1, input));
+			if (*symbol == m_grammar->endmark()) {
+				// error: undefined symbol
+				m_result = ParseResult {false, m_curr_line, input};
+				return false;
+			}
+			if (!state->transit(*symbol)) {
+				// fallback
+				if (symbol->type() == SymbolType::MULTITERMINAL) {
+					symbol = &symbol->shared_terminal();
+				}
+			}
+			State::ID next_state = 0, last_final = 0;
+			if (state->is_final()) {
+				last_final = state->id();
+			}
+			while (state->transit(*symbol, next_state)) {
+				state = &m_builder->get_state(next_state);
+				if (state->is_final()) {
+					last_final = state->id();
+					last_final_pos = parse_pos;
+				}
+				// next symbol
+				if (++parse_pos == m_end && !refill(start_pos)) {
+					break;
+				}
+				input = m_data[parse_pos - m_base];
+				if (isspace(static_cast<unsigned char>(input))) {
+					break;
+				}
+				symbol = &m_grammar->get_symbol(std::string(1, input));
+				if (*symbol == m_grammar->endmark()) {
+					// error: undefined symbol
+					m_result = ParseResult {false, m_curr_line, input};
+					return false;
+				}
+				if (!state->transit(*symbol)) {
+					// fallback
+					if (symbol->type() == SymbolType::MULTITERMINAL) {
+						symbol = &symbol->shared_terminal();
+					}
+				}
+			}
+			if (last_final != 0) {
+				index = m_builder->get_state(last_final).token_index();
+			}
+		}
+		if (index == 0) {
+			// err: not in a final state
+			m_result = ParseResult {false, m_curr_line, input};
+			return false;
+		}
+
+		// recognize a token
+		m_pos = last_final_pos + 1;
+		m_lexeme.assign(m_data + (start_pos - m_base), m_pos - start_pos);
+		// check token precedence(e.g. key-words)
+		if (m_table) {
+			index = m_table->resolve(index, m_lexeme);
+		}
+		else {
+			auto& self = m_grammar->get_symbol(m_lexeme);
+			if (self != m_grammar->endmark() && self.is_token()) {
+				if (self.precedence() > m_grammar->get_symbol(index).precedence()) {
+					index = self.index();
+				}
+			}
+		}
+		m_tokens.push_back(Token {start_pos, std::uint32_t(m_pos - start_pos), std::uint32_t(index)});
+		return true;
+	}
+
+	bool Tokenizer::refill(std::size_t keep) {
+		if (m_stream == nullptr) {
+			return false;
+		}
+		// drop the bytes no kept token refers to
+		if (!m_tokens.empty()) {
+			keep = std::min(keep, m_tokens.front().offset);
+		}
+		m_source.erase(0, keep - m_base);
+		m_base = keep;
+		auto size = m_source.size();
+		m_source.resize(size + m_chunk);
+		m_stream->read(&m_source[size], m_chunk);
+		m_source.resize(size + std::size_t(m_stream->gcount()));
+		m_data = m_source.data();
+		m_end = m_base + m_source.size();
+		return m_source.size() > size;
+	}
+
+	const Token& Tokenizer::next() {
+		has_next();
+		return m_tokens[m_current++];
+	}
+
+	const Token& Tokenizer::peek() {
+		has_next();
+		return m_tokens[m_current];
+	}
+
+	bool Tokenizer::has_next() {
+		if (m_current < m_tokens.size()) {
+			return true;
+		}
+		if (m_stream == nullptr) {
+			return false;
+		}
+		// keep only the last token got by next(), whose lexeme may still be in use
+		if (m_current > 1) {
+			m_tokens.erase(m_tokens.begin(), m_tokens.begin() + (m_current - 1));
+			m_current = 1;
+		}
+		return lex();
+	}
+
+	boost::string_ref Tokenizer::text(const Token& token) const {
+		return boost::string_ref(m_data + (token.offset - m_base), token.length);
+	}
+
+	std::string Tokenizer::value(const Token& token) const {
+		return std::string(m_data + (token.offset - m_base), token.length);
+	}
+
+	std::size_t Tokenizer::type_count() const {
+		return m_type_names.size();
+	}
+
+	const std::string& Tokenizer::type_name(std::size_t type) const {
+		return m_type_names[type];
+	}
+
+	void Tokenizer::report() const {
+		std::ofstream file;
+		file.open("report\\token_stream", std::ios::trunc);
+		auto cols = 5, col = 0;
+		for (auto& token : m_tokens) {
+			std::string t(m_type_names[token.type]);
+			t.insert(0, "( ").append("  ").append(m_data + (token.offset - m_base), token.length).append(" )");
+			file << std::setw(30) << std::left << t;
+			if (++col == cols) {
+				col = 0;
+				file << '\n';
+			}
+		}
+		file.close();
+	}
+
 }
\ No newline at end of file
@@ -1,69 +1,141 @@
-#pragma once
-
-#include "StateBuilder.h"
-
-namespace pitaya {
-
-	/*!
-		\ingroup LA
-		Token struct.
-	*/
-	struct Token {
-
-		const char* type;
-		std::string value;
-
-	};
-
-	/*!
-		\ingroup LA
-		Tokenizer class.
-	*/
-	class Tokenizer {
-
-	public:
-
-		struct ParseResult {
-
-			bool success;
-			std::size_t err_line;
-			char err_input;
-
-		};
-
-		//! Constructor.
-		Tokenizer(Grammar&, StateBuilder&);
-
-		//! Parse a source file.
-		ParseResult parse(std::ifstream&);
-
-		//! Get the next token.
-		const Token& next();
-
-		//! Peek the next token.
-		const Token& peek();
-
-		//! Whether there are any tokens left.
-		bool has_next() const;
-
-		//! Generate report file.
-		void report() const;
-
-	private:
-
-		Grammar& m_grammar;				//!< The grammar.
-		StateBuilder& m_builder;		//!< The state builder.
-		std::vector<Token> m_tokens;	//!< The token stream.
-		std::size_t m_current;			//!< Index of the token stream.
-		std::size_t m_curr_line;		//!< Current line number.
-
-		/// @cond
-		static auto& pool() {
-			static std::unordered_set<std::string> interned_;
-			return interned_;
-		}
-		/// @endcond
-
-	};
-
+#pragma once
+
+#include "LexTable.h"
+
+#include <istream>
+
+#include <boost\utility\string_ref.hpp>
+
+namespace pitaya {
+
+	/*!
+		\ingroup LA
+		Token struct.
+
+		A token refers to its lexeme in the source buffer,
+		use Tokenizer::text() or Tokenizer::value() to get it.
+	*/
+	struct Token {
+
+		std::size_t offset;		//!< Offset of the lexeme in the source.
+		std::uint32_t length;	//!< Length of the lexeme.
+		std::uint32_t type;		//!< Index of the token symbol in the lexical grammar.
+
+	};
+
+	/*!
+		\ingroup LA
+		Tokenizer class.
+	*/
+	class Tokenizer {
+
+	public:
+
+		struct ParseResult {
+
+			bool success;
+			std::size_t err_line;
+			char err_input;
+
+		};
+
+		//! Constructor.
+		Tokenizer(Grammar&, StateBuilder&);
+
+		//! Constructor.
+		/*!
+			Scan with a compiled DFA, neither the grammar nor the builder is used.
+			\param table The table must outlive this tokenizer.
+		*/
+		Tokenizer(const LexTable& table);
+
+		//! Parse a source file.
+		/*!
+			The whole file is read into an internal buffer which is then parsed.
+		*/
+		ParseResult parse(std::ifstream&);
+
+		//! Parse a contiguous source buffer, e.g. a memory-mapped file.
+		/*!
+			Tokens refer to the buffer, so it must outlive them.
+		*/
+		ParseResult parse(const char* data, std::size_t size);
+
+		//! Tokenize a stream on demand.
+		/*!
+			Nothing is read until a token is requested by has_next(), peek() or next(),
+			which read the stream chunk by chunk and scan one token at a time.
+			Only the lookahead token and the last token got by next() are kept,
+			so memory does not grow with the input.
+			Use result() to tell the end of input from a lexical error.
+			\param chunk Number of bytes read at a time.
+		*/
+		void open(std::istream&, std::size_t chunk = 1 << 16);
+
+		//! Result of parsing or streaming so far.
+		const ParseResult& result() const;
+
+		//! Get the next token.
+		const Token& next();
+
+		//! Peek the next token.
+		const Token& peek();
+
+		//! Whether there are any tokens left.
+		bool has_next();
+
+		//! Lexeme of a token.
+		/*!
+			When streaming, only the lexemes of the kept tokens are available.
+		*/
+		boost::string_ref text(const Token&) const;
+
+		//! Copy of the lexeme of a token.
+		std::string value(const Token&) const;
+
+		//! Number of token types, i.e. symbols of the lexical grammar.
+		std::size_t type_count() const;
+
+		//! Name of a token type.
+		const std::string& type_name(std::size_t type) const;
+
+		//! Generate report file.
+		void report() const;
+
+	private:
+
+		Grammar* m_grammar;				//!< The grammar.
+		StateBuilder* m_builder;		//!< The state builder.
+		const LexTable* m_table;		//!< The compiled DFA, or nullptr.
+		std::vector<std::string> m_type_names;	//!< Names of token types.
+
+		std::istream* m_stream;			//!< The stream being tokenized, or nullptr.
+		std::size_t m_chunk;			//!< Number of bytes read from the stream at a time.
+		std::string m_source;			//!< Source read by parse(std::ifstream&), or the stream window.
+		const char* m_data;				//!< The source buffer(window) tokens refer to.
+		std::size_t m_base;				//!< Offset of m_data in the source.
+		std::size_t m_end;				//!< Offset of the end of m_data in the source.
+		std::size_t m_pos;				//!< Offset of the next byte to scan.
+
+		std::string m_lexeme;			//!< The lexeme being checked for key-words.
+		std::vector<Token> m_tokens;	//!< The token stream.
+		std::size_t m_current;			//!< Index of the token stream.
+		std::size_t m_curr_line;		//!< Current line number.
+		ParseResult m_result;			//!< Result so far.
+
+		//! Scan the next token into m_tokens.
+		/*!
+			\return false at the end of input or on error.
+		*/
+		bool lex();
+
+		//! Read the next chunk of the stream.
+		/*!
+			\param keep Offset of the first byte still needed by the caller.
+			\return false at the end of the stream.
+		*/
+		bool refill(std::size_t keep);
+
+	};
+
 }
\ No newline at end of file
@@ -1,28 +1,29 @@
-#include "Action.h"
-
-#include <map>
-#include <string>
-
-namespace pitaya {
-
-	Action::Action(ActionType type, std::size_t value)
-		: type {type}, value {value} {}
-
-	std::ostream& operator<<(std::ostream& os, ActionType type) {
-		static std::map<ActionType, std::string> strings;
-		if (strings.size() == 0) {
-#define INSERT_ELEMENT(p) strings[p] = std::string(#p).substr(12)
-			INSERT_ELEMENT(ActionType::SHIFT);
-			INSERT_ELEMENT(ActionType::REDUCE);
-			INSERT_ELEMENT(ActionType::GOTO);
-			INSERT_ELEMENT(ActionType::ACCEPT);
-			INSERT_ELEMENT(ActionType::ERROR);
-			INSERT_ELEMENT(ActionType::SSCONFLICT);
-			INSERT_ELEMENT(ActionType::SRCONFLICT);
-			INSERT_ELEMENT(ActionType::RRCONFLICT);
-#undef INSERT_ELEMENT
-		}
-		return os << strings[type];
-	}
-
+#include "Action.h"
+
+
+namespace pitaya {
+
+	Action::Action(ActionType type, std::size_t value)
+		: type {type}, value {value} {}
+
+	bool Action::is_explicit_error() const {
+		return type == ActionType::ERROR && value == EXPLICIT_ERROR;
+	}
+
+	std::ostream& operator<<(std::ostream& os, ActionType type) {
+#define CASE_ELEMENT(p) case p: return os << (#p + 12)
+		switch (type) {
+			CASE_ELEMENT(ActionType::SHIFT);
+			CASE_ELEMENT(ActionType::REDUCE);
+			CASE_ELEMENT(ActionType::GOTO);
+			CASE_ELEMENT(ActionType::ACCEPT);
+			CASE_ELEMENT(ActionType::ERROR);
+			CASE_ELEMENT(ActionType::SSCONFLICT);
+			CASE_ELEMENT(ActionType::SRCONFLICT);
+			CASE_ELEMENT(ActionType::RRCONFLICT);
+		}
+#undef CASE_ELEMENT
+		return os;
+	}
+
 }
\ No newline at end of file
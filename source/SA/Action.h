@@ -1,40 +1,46 @@
-#pragma once
-
-#include <iostream>
-
-namespace pitaya {
-
-	/*!
-		\ingroup SA
-		Action type.
-	*/
-	enum class ActionType {
-
-		SHIFT,
-		REDUCE,
-		GOTO,
-		ACCEPT,
-		ERROR,
-		SSCONFLICT,		//!< A shift-shift conflict
-		SRCONFLICT,		//!< A shift-reduce conflict
-		RRCONFLICT,		//!< A reduce-reduce conflict
-
-	};
-
-	/*!
-		\ingroup SA
-		Action struct.
-	*/
-	struct Action {
-
-		ActionType type;
-
-		std::size_t value;	//!< StateID when type is SHIFT, ProductionID when type is REDUCE
-
-		Action(ActionType, std::size_t value);
-
-	};
-
-	std::ostream& operator<<(std::ostream&, ActionType);
-
+#pragma once
+
+#include <iostream>
+
+namespace pitaya {
+
+	/*!
+		\ingroup SA
+		Action type.
+	*/
+	enum class ActionType {
+
+		ERROR,			//!< Zero, so that zero-filled tables mean errors
+		SHIFT,
+		REDUCE,
+		GOTO,
+		ACCEPT,
+		SSCONFLICT,		//!< A shift-shift conflict
+		SRCONFLICT,		//!< A shift-reduce conflict
+		RRCONFLICT,		//!< A reduce-reduce conflict
+
+	};
+
+	/*!
+		\ingroup SA
+		Action struct.
+	*/
+	struct Action {
+
+		ActionType type;
+
+		std::size_t value;	//!< StateID when type is SHIFT, ProductionID when type is REDUCE, EXPLICIT_ERROR when an ERROR is explicit
+
+		//! Value of an ERROR set on purpose, e.g. for a nonassociative operator, rather than a missing action.
+		static const std::size_t EXPLICIT_ERROR = 1;
+
+		Action(ActionType, std::size_t value);
+
+		//! Whether this is an ERROR set on purpose, which a multi-terminal must not fall back from.
+		bool is_explicit_error() const;
+
+	};
+
+	std::ostream& operator<<(std::ostream&, ActionType);
+
 }
\ No newline at end of file
@@ -0,0 +1,263 @@
+#include "CodeGenerator.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace pitaya {
+
+	namespace {
+
+		// a C++ string literal of s
+		std::string quote(const std::string& s) {
+			std::ostringstream os;
+			os << '"';
+			for (auto c : s) {
+				auto u = static_cast<unsigned char>(c);
+				if (c == '"' || c == '\\') {
+					os << '\\' << c;
+				}
+				else if (u < 0x20 || u >= 0x7f) {
+					// octal escapes never swallow the following characters beyond three digits
+					os << '\\' << char('0' + (u >> 6)) << char('0' + ((u >> 3) & 7)) << char('0' + (u & 7));
+				}
+				else {
+					os << c;
+				}
+			}
+			os << '"';
+			return os.str();
+		}
+
+		// a constexpr array, 16 elements a line
+		template<typename T>
+		void array(std::ostream& os, const char* type, const char* name, const std::vector<T>& v) {
+			os << "\tconstexpr " << type << ' ' << name << '[' << std::max<std::size_t>(v.size(), 1) << "] = {";
+			for (std::size_t i = 0; i < v.size(); i++) {
+				os << (i % 16 == 0 ? "\n\t\t" : " ") << v[i] << ',';
+			}
+			if (v.empty()) {
+				// zero-sized arrays are not allowed
+				os << "\n\t\t0";
+			}
+			os << "\n\t};\n\n";
+		}
+
+		void strings(std::ostream& os, const char* name, const std::vector<std::string>& v) {
+			os << "\tconstexpr const char* " << name << '[' << v.size() << "] = {\n";
+			for (auto& s : v) {
+				os << "\t\t" << quote(s) << ",\n";
+			}
+			os << "\t};\n\n";
+		}
+
+		// the driver, it refers to the tables by the names emitted above
+		const char* DRIVER = R"(	//! A token scanned by lex().
+	struct Token {
+		std::size_t offset;		//!< Offset of the lexeme in the source.
+		std::size_t length;		//!< Length of the lexeme.
+		std::uint32_t type;		//!< Index of the token symbol, see lex_names.
+	};
+
+	//! Result of lex().
+	enum class LexResult { TOKEN, END, ERROR };
+
+	//! Compare a key-word with a lexeme, in the order of std::strcmp.
+	inline int lex_compare(const char* keyword, const char* lexeme, std::size_t length) {
+		auto c = std::strncmp(keyword, lexeme, length);
+		return c != 0 ? c : keyword[length] != '\0';
+	}
+
+	//! Scan the token starting at or after pos, and move pos past it.
+	inline LexResult lex(const char* data, std::size_t size, std::size_t& pos, Token& token) {
+		while (pos < size && std::isspace(static_cast<unsigned char>(data[pos]))) {
+			pos++;
+		}
+		if (pos == size) return LexResult::END;
+
+		// the longest lexeme ending in a final state
+		auto start = pos, last = pos;
+		auto row = lex_start;
+		auto index = lex_tokens[row];
+		auto next = lex_transitions[row * 256 + static_cast<unsigned char>(data[pos])];
+		while (next >= 0) {
+			row = std::uint32_t(next);
+			if (lex_tokens[row] != 0) {
+				index = lex_tokens[row];
+				last = pos;
+			}
+			if (++pos == size) break;
+			next = lex_transitions[row * 256 + static_cast<unsigned char>(data[pos])];
+		}
+		if (next == lex_undefined || index == 0) return LexResult::ERROR;
+		pos = last + 1;
+		token = Token {start, pos - start, index};
+
+		// a key-word spelled exactly as the lexeme takes over,
+		// only those able to override this token type are searched, by their sorted spellings
+		auto low = lex_keyword_offsets[index], high = lex_keyword_offsets[index + 1];
+		while (low < high) {
+			auto mid = low + (high - low) / 2;
+			auto c = lex_compare(lex_names[lex_keywords[mid]], data + start, token.length);
+			if (c == 0) {
+				token.type = lex_keywords[mid];
+				break;
+			}
+			if (c < 0) {
+				low = mid + 1;
+			}
+			else {
+				high = mid;
+			}
+		}
+		return LexResult::TOKEN;
+	}
+
+	//! Handler ignoring everything.
+	struct NullHandler {
+		void shift(std::uint32_t, const char*, std::size_t) {}
+		void reduce(std::uint32_t) {}
+	};
+
+	//! Parse a source buffer.
+	/*!
+		\param handler Gets shift(type, text, length) for every token
+		and reduce(production) for every reduction.
+		\return Whether the source is accepted.
+	*/
+	template<typename Handler>
+	bool parse(const char* data, std::size_t size, Handler& handler) {
+		std::vector<std::uint32_t> stack {parse_start};
+		std::size_t pos = 0;
+		Token token {};
+		auto result = lex(data, size, pos, token);
+		while (true) {
+			if (result == LexResult::ERROR) return false;
+			auto column = parse_endmark;
+			if (result == LexResult::TOKEN) {
+				if (token_columns[token.type] < 0) return false;
+				column = std::uint32_t(token_columns[token.type]);
+			}
+			auto entry = parse_actions[stack.back() * parse_action_width + column];
+			switch (entry >> parse_type_shift) {
+				case parse_shift:
+					stack.push_back(entry & parse_value_mask);
+					handler.shift(token.type, data + token.offset, token.length);
+					result = lex(data, size, pos, token);
+					break;
+				case parse_reduce:
+				{
+					auto production = entry & parse_value_mask;
+					stack.resize(stack.size() - parse_rhs_count[production]);
+					auto go = parse_gotos[stack.back() * parse_goto_width + parse_lhs[production]];
+					stack.push_back(go & parse_value_mask);
+					handler.reduce(production);
+				}
+				break;
+				case parse_accept:
+					return true;
+				default:
+					return false;
+			}
+		}
+	}
+
+	//! Parse a source buffer, only to tell whether it is accepted.
+	inline bool parse(const char* data, std::size_t size) {
+		NullHandler handler;
+		return parse(data, size, handler);
+	}
+)";
+
+	}
+
+	CodeGenerator::CodeGenerator(const LexTable& lexer, const ParseTable& parser)
+		: m_lexer {lexer}, m_parser {parser} {}
+
+	bool CodeGenerator::generate(std::ostream& os, const std::string& name) const {
+		auto& lexer = m_lexer;
+		auto& parser = m_parser;
+
+		os << "// Generated by pitaya, do not edit.\n"
+			<< "#pragma once\n\n"
+			<< "#include <cctype>\n"
+			<< "#include <cstddef>\n"
+			<< "#include <cstdint>\n"
+			<< "#include <cstring>\n"
+			<< "#include <vector>\n\n"
+			<< "namespace " << name << " {\n\n";
+
+		// lexer
+		// a key-word overrides the token type its spelling is scanned as, if its precedence is higher,
+		// so the key-words are grouped by the type they override and sorted by spelling within a group
+		std::vector<std::vector<std::pair<std::string, std::size_t>>> overrides(lexer.symbol_count());
+		for (auto& k : lexer.m_keywords) {
+			auto row = lexer.start();
+			bool scanned = true;
+			for (auto c : k.first) {
+				auto next = lexer.transit(row, static_cast<unsigned char>(c));
+				if (next < 0) {
+					scanned = false;
+					break;
+				}
+				row = LexTable::Row(next);
+			}
+			auto index = scanned ? lexer.token_index(row) : 0;
+			if (index != 0 && lexer.m_precedences[k.second] > lexer.m_precedences[index]) {
+				overrides[index].push_back(k);
+			}
+		}
+		std::vector<std::size_t> keywords, offsets;
+		for (auto& group : overrides) {
+			std::sort(group.begin(), group.end());
+			offsets.push_back(keywords.size());
+			for (auto& k : group) {
+				keywords.push_back(k.second);
+			}
+		}
+		offsets.push_back(keywords.size());
+		os << "\tconstexpr std::uint32_t lex_start = " << lexer.m_start << ";\n"
+			<< "\tconstexpr std::int32_t lex_undefined = " << LexTable::UNDEFINED << ";\n\n";
+		array(os, "std::int32_t", "lex_transitions", lexer.m_transitions);
+		array(os, "std::uint32_t", "lex_tokens", lexer.m_tokens);
+		// key-words overriding token type t are lex_keywords[lex_keyword_offsets[t], lex_keyword_offsets[t + 1])
+		array(os, "std::uint32_t", "lex_keyword_offsets", offsets);
+		array(os, "std::uint32_t", "lex_keywords", keywords);
+		strings(os, "lex_names", lexer.m_names);
+
+		// parser
+		os << "\tconstexpr std::uint32_t parse_start = " << parser.m_start << ";\n"
+			<< "\tconstexpr std::uint32_t parse_endmark = " << parser.endmark() << ";\n"
+			<< "\tconstexpr std::uint32_t parse_action_width = " << parser.m_action_width << ";\n"
+			<< "\tconstexpr std::uint32_t parse_goto_width = " << parser.m_goto_width << ";\n"
+			<< "\tconstexpr std::uint32_t parse_type_shift = " << unsigned(ParseTable::TYPE_SHIFT) << ";\n"
+			<< "\tconstexpr std::uint32_t parse_value_mask = " << unsigned(ParseTable::VALUE_MASK) << ";\n"
+			<< "\tconstexpr std::uint32_t parse_shift = " << to_integral(ActionType::SHIFT) << ";\n"
+			<< "\tconstexpr std::uint32_t parse_reduce = " << to_integral(ActionType::REDUCE) << ";\n"
+			<< "\tconstexpr std::uint32_t parse_accept = " << to_integral(ActionType::ACCEPT) << ";\n\n";
+		array(os, "std::uint32_t", "parse_actions", parser.m_actions);
+		array(os, "std::uint32_t", "parse_gotos", parser.m_gotos);
+		array(os, "std::uint32_t", "parse_lhs", parser.m_lhs);
+		array(os, "std::uint32_t", "parse_rhs_count", parser.m_rhs_count);
+
+		std::vector<std::string> productions;
+		for (ProductionID pid = 0; pid < parser.m_lhs.size(); pid++) {
+			std::ostringstream p;
+			parser.print(p, pid);
+			productions.push_back(p.str());
+		}
+		strings(os, "parse_productions", productions);
+
+		// action columns of token types, -1 if the parser does not know the token
+		std::vector<std::int64_t> columns;
+		for (std::size_t type = 0; type < lexer.symbol_count(); type++) {
+			auto symbol = parser.symbol(lexer.name(type));
+			bool known = symbol != ParseTable::npos && !parser.is_nonterminal(symbol);
+			columns.push_back(known ? std::int64_t(parser.column(symbol)) : -1);
+		}
+		array(os, "std::int32_t", "token_columns", columns);
+
+		os << DRIVER << "\n}\n";
+		return os.good();
+	}
+
+}
\ No newline at end of file
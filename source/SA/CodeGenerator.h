@@ -0,0 +1,45 @@
+#pragma once
+
+#include "LexTable.h"
+#include "ParseTable.h"
+
+#include <ostream>
+#include <string>
+
+namespace pitaya {
+
+	/*!
+		\ingroup SA
+		CodeGenerator class.
+
+		Emits a self-contained C++ header from a LexTable and a ParseTable.
+		The header holds both tables as constexpr arrays, a lex() function scanning one token,
+		and a parse() function template driving the tables, which calls back
+		handler.shift(type, text, length) for every token and handler.reduce(production)
+		for every reduction. The generated code depends on the standard library only.
+	*/
+	class CodeGenerator {
+
+	public:
+
+		//! Constructor.
+		/*!
+			\param lexer The tables must outlive the generator.
+		*/
+		CodeGenerator(const LexTable& lexer, const ParseTable& parser);
+
+		//! Emit the header.
+		/*!
+			\param name Namespace of the generated code.
+			\return Whether everything has been written.
+		*/
+		bool generate(std::ostream&, const std::string& name) const;
+
+	private:
+
+		const LexTable& m_lexer;		//!< The lexer table.
+		const ParseTable& m_parser;		//!< The parser table.
+
+	};
+
+}
\ No newline at end of file
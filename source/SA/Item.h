@@ -1,77 +1,115 @@
-#pragma once
-
-#include "BasicItem.h"
-
-namespace pitaya {
-
-	/*!
-		\defgroup SA
-		@{
-	*/
-
-	class Item;
-
-	//! Node on propagation links.
-	/*
-		Used in lookaheads computation.
-	*/
-	struct PLinkNode {
-		const Item* item;
-		PLinkNode* next;
-		PLinkNode() : item {}, next {} {}
-	};
-
-	//! Item class.
-	class Item : public BasicItem {
-
-	public:
-
-		//! Constructor.
-		Item(ProductionID, Dot = 0);
-
-		//! Move constructor.
-		Item(Item&&) noexcept;
-
-		//! Move assignment.
-		Item& operator=(Item&&) noexcept;
-
-		//! Generated copy constructor.
-		Item(const Item&) = default;
-
-		//! Generated copy assignment.
-		Item& operator=(const Item&) = default;
-
-		//! Whether the item is a kernel.
-		bool is_kernel() const;
-
-		//! Getter for m_lookaheads.
-		SymbolSet& lookaheads() const;
-
-		//! Getter for m_forward_plink.
-		PLinkNode*& forward_plink() const;
-
-		//! Getter for m_backward_plink.
-		PLinkNode*& backward_plink() const;
-
-		//! Used in item-set closure\\successors\\lookaheads computing.
-		/*!
-			Declared mutable because it will be updated after being added to set.
-		*/
-		mutable bool complete;
-
-	private:
-
-		//! Lookaheads of the item.
-		/*!
-			Declared mutable because it will be updated after being added to set.
-		*/
-		mutable SymbolSet m_lookaheads;
-
-		mutable PLinkNode* m_forward_plink;		//!< Forward propagation link.
-		mutable PLinkNode* m_backward_plink;	//!< Backward propagation link.
-
-	};
-
-	/** @}*/ // end of SA group
-
+#pragma once
+
+#include "BasicItem.h"
+
+#include <memory>
+#include <vector>
+
+namespace pitaya {
+
+	/*!
+		\defgroup SA
+		@{
+	*/
+
+	class Item;
+
+	//! Node on propagation links.
+	/*
+		Used in lookaheads computation.
+	*/
+	struct PLinkNode {
+		const Item* item;
+		PLinkNode* next;
+		PLinkNode() : item {}, next {} {}
+	};
+
+	//! Arena of PLinkNodes.
+	/*!
+		Nodes are allocated from blocks and never freed one by one,
+		all of them are released together with the pool.
+	*/
+	class PLinkPool {
+
+	public:
+
+		//! Constructor.
+		PLinkPool();
+
+		//! Get a new node.
+		PLinkNode* allocate();
+
+		//! Number of nodes allocated.
+		std::size_t size() const;
+
+	private:
+
+		std::vector<std::unique_ptr<PLinkNode[]>> m_blocks;	//!< All blocks.
+		std::size_t m_used;						//!< Number of nodes used in the last block.
+
+		/// @cond
+		static const std::size_t BLOCK_SIZE = 4096;
+		/// @endcond
+
+	};
+
+	//! Item class.
+	class Item : public BasicItem {
+
+	public:
+
+		//! Constructor.
+		Item(ProductionID, Dot = 0);
+
+		//! Move constructor.
+		Item(Item&&) noexcept;
+
+		//! Move assignment.
+		Item& operator=(Item&&) noexcept;
+
+		//! Generated copy constructor.
+		Item(const Item&) = default;
+
+		//! Generated copy assignment.
+		Item& operator=(const Item&) = default;
+
+		//! Whether the item is a kernel.
+		bool is_kernel() const;
+
+		//! Rebase the item on its production, renumbered by an edit of the grammar.
+		void rebase(ProductionID);
+
+		//! Getter for m_lookaheads.
+		/*!
+			The lookaheads are a row of the bit-matrix of the item-set containing the item.
+		*/
+		SymbolRow& lookaheads() const;
+
+		//! Getter for m_forward_plink.
+		PLinkNode*& forward_plink() const;
+
+		//! Getter for m_backward_plink.
+		PLinkNode*& backward_plink() const;
+
+		//! Used in item-set closure\\successors\\lookaheads computing.
+		/*!
+			Declared mutable because it will be updated after being added to set.
+		*/
+		mutable bool complete;
+
+	private:
+
+		//! Lookaheads of the item.
+		/*!
+			Declared mutable because it will be updated after being added to set.
+		*/
+		mutable SymbolRow m_lookaheads;
+
+		mutable PLinkNode* m_forward_plink;		//!< Forward propagation link.
+		mutable PLinkNode* m_backward_plink;	//!< Backward propagation link.
+
+	};
+
+	/** @}*/ // end of SA group
+
 }
\ No newline at end of file
@@ -1,159 +1,182 @@
-﻿#include "ItemSet.h"
-#include "Grammar.h"
-#include "ItemSetBuilder.h"
-
-#include <algorithm>
-#include <cassert>
-
-#include <boost\functional\hash\hash.hpp>
-
-namespace pitaya {
-
-	ItemSet::ItemSet()
-		: m_id {order()}, m_kernels {}, m_closure {}, m_actions {} {}
-
-	ItemSet::ItemSet(ItemSet&& from) noexcept
-		: m_id {order()},
-		m_kernels {std::move(from.m_kernels)},
-		m_closure {std::move(from.m_closure)},
-		m_actions {std::move(from.m_actions)} {
-		// ensure 'from' is empty after move
-		from.reset();
-	}
-
-	StateID ItemSet::id() const {
-		return m_id;
-	}
-
-	Item& ItemSet::add_kernel(const Production& p, Item::Dot d) {
-		m_kernels.emplace_back(p.id(), d);
-		return m_kernels.back();
-	}
-
-	void ItemSet::compute_closure(Grammar& grammar, ItemSetBuilder& builder) {
-		// copy kernels into closure
-		for (auto& i : m_kernels) {
-			m_closure.emplace(i);
-		}
-
-		auto progress = 0;
-		do {
-			progress = 0;
-			for (auto& item : m_closure) {
-				if (item.complete) continue;
-				auto& production = grammar.get_production(item.production_id());
-				auto dot = item.dot();
-				if (dot >= production.rhs_count()) {
-					// skip item whose dot is at right end
-					item.complete = true;
-					continue;
-				}
-				auto& symbol = production[dot + 1];				// symbol after dot
-				if (symbol.type() != SymbolType::NONTERMINAL) {
-					// not a nonterminal, cannot contribute any more items
-					item.complete = true;
-					continue;
-				}
-				// for each production with 'symbol' as its lhs
-				auto range = grammar.productions_by_lhs(symbol);
-				for (auto pid = range.first; pid <= range.second; pid++) {
-					auto& p = grammar.get_production(pid);
-					auto& res = m_closure.emplace(p.id());
-					if (res.second) {
-						progress++;
-					}
-					// update lookaheads generated spontaneously
-					if (res.second) {
-						res.first->lookaheads().resize(grammar.symbol_count());
-					}
-					// A -> α.Bβ, a
-					// B -> γ, b where b ∈ first(βa)
-					std::size_t i = dot + 1;
-					for (i; i < production.rhs_count(); i++) {
-						auto& rhs = production[i + 1];
-						if (rhs.type() != SymbolType::NONTERMINAL) {
-							res.first->lookaheads().add(rhs);
-							break;
-						}
-						else {
-							res.first->lookaheads().union_with(rhs.first_set());
-							if (!rhs.lambda()) break;
-						}
-					}
-					// if β is empty, add forward propagation link
-					if (i == production.rhs_count()) {
-						auto& new_node = builder.new_link();
-						new_node->next = item.forward_plink();
-						item.forward_plink() = new_node;
-						new_node->item = &(*res.first);
-					}
-				}
-				item.complete = true;
-				if (progress != 0) {
-					// closure has changed
-					// if rehashing occurs due to the insertion, all iterators are invalidated
-					// so re-iterate for safety
-					break;
-				}
-			}
-		} while (progress != 0);
-	}
-
-	Action& ItemSet::add_action(const Symbol& symbol, ActionType type, std::size_t value) const {
-		auto& res = m_actions.emplace(symbol.index(), Action {type, value});
-		Action& act = res.first->second;
-		if (!res.second) {
-			// a conflict has occurred
-			if (type == ActionType::SHIFT) {
-				if (act.type == ActionType::SHIFT) {
-					act.type = ActionType::SSCONFLICT;
-				}
-			}
-			else if (type == ActionType::REDUCE) {
-				if (act.type == ActionType::SHIFT) {
-					act.type = ActionType::SRCONFLICT;
-				}
-				else if (act.type == ActionType::REDUCE) {
-					act.type = ActionType::RRCONFLICT;
-				}
-			}
-		}
-		return act;
-	}
-
-	Action ItemSet::evaluate(const Symbol& symbol) const {
-		auto& find = m_actions.find(symbol.index());
-		if (find != m_actions.end()) {
-			return find->second;
-		}
-		return Action {ActionType::ERROR, 0};
-	}
-
-	void ItemSet::sort() {
-		std::sort(m_kernels.begin(), m_kernels.end(), [](auto& a, auto& b) {
-			if (a.production_id() != b.production_id()) {
-				return a.production_id() < b.production_id();
-			}
-			else {
-				return a.dot() < b.dot();
-			}
-		});
-	}
-
-	void ItemSet::reset() {
-		m_kernels.clear();
-		m_closure.clear();
-		m_actions.clear();
-	}
-
-	bool operator==(const ItemSet& a, const ItemSet& b) {
-		// sort m_kernels so that the order does not matter here
-		return a.m_kernels == b.m_kernels;
-	}
-
-	std::size_t hash_value(const ItemSet& set) {
-		// sort m_kernels so that the order does not matter here
-		return boost::hash_range(set.m_kernels.begin(), set.m_kernels.end());
-	}
-
+﻿#include "ItemSet.h"
+#include "Grammar.h"
+#include "ItemSetBuilder.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <boost\functional\hash\hash.hpp>
+
+namespace pitaya {
+
+	ItemSet::ItemSet()
+		: m_items {}, m_kernel_count {}, m_lookaheads {}, m_id {}, m_actions {}, m_successors {} {}
+
+	ItemSet::ItemSet(ItemSet&& from) noexcept
+		: m_items {std::move(from.m_items)},
+		m_kernel_count {from.m_kernel_count},
+		m_lookaheads {std::move(from.m_lookaheads)},
+		m_id {from.m_id},
+		m_actions {std::move(from.m_actions)},
+		m_successors {std::move(from.m_successors)} {
+		// ensure 'from' is empty after move
+		from.reset();
+	}
+
+	StateID ItemSet::id() const {
+		return m_id;
+	}
+
+	Item& ItemSet::add_kernel(const Production& p, Item::Dot d) {
+		m_items.emplace_back(p.id(), d);
+		m_kernel_count++;
+		return m_items.back();
+	}
+
+	void ItemSet::compute_closure(Grammar& grammar, const ItemSetBuilder& builder, PLinkPool& pool) {
+		// positions of items whose dots are at left end
+		std::unordered_map<ProductionID, std::size_t> positions;
+		for (std::size_t i = 0; i < m_kernel_count; i++) {
+			if (m_items[i].dot() == 0) {
+				positions.emplace(m_items[i].production_id(), i);
+			}
+		}
+
+		for (std::size_t i = 0; i < m_kernel_count; i++) {
+			auto& production = grammar.get_production(m_items[i].production_id());
+			auto dot = m_items[i].dot();
+			if (dot >= production.rhs_count()) continue;		// skip item whose dot is at right end
+			auto& symbol = production[dot + 1];				// symbol after dot
+			if (symbol.type() != SymbolType::NONTERMINAL) continue;
+			// append the closure items
+			for (auto& t : builder.closure_template(symbol)) {
+				if (positions.emplace(t.production, m_items.size()).second) {
+					m_items.emplace_back(t.production);
+				}
+			}
+		}
+
+		// the item vector is complete, allocate lookaheads
+		auto n = grammar.symbol_count();
+		auto words = SymbolRow::words(n);
+		m_lookaheads.assign(m_items.size() * words, 0);
+		for (std::size_t i = 0; i < m_items.size(); i++) {
+			m_items[i].lookaheads() = SymbolRow(&m_lookaheads[i * words], n);
+		}
+
+		generate_lookaheads(grammar, builder, positions, &pool);
+	}
+
+	void ItemSet::regenerate_lookaheads(Grammar& grammar, const ItemSetBuilder& builder) const {
+		std::unordered_map<ProductionID, std::size_t> positions;
+		for (std::size_t i = 0; i < m_items.size(); i++) {
+			if (m_items[i].dot() == 0) {
+				positions.emplace(m_items[i].production_id(), i);
+			}
+		}
+		generate_lookaheads(grammar, builder, positions, nullptr);
+	}
+
+	void ItemSet::generate_lookaheads(Grammar& grammar, const ItemSetBuilder& builder,
+									  const std::unordered_map<ProductionID, std::size_t>& positions, PLinkPool* pool) const {
+		SymbolSet first;
+		for (std::size_t i = 0; i < m_kernel_count; i++) {
+			auto& kernel = m_items[i];
+			auto& production = grammar.get_production(kernel.production_id());
+			auto dot = kernel.dot();
+			if (dot >= production.rhs_count() || production[dot + 1].type() != SymbolType::NONTERMINAL) continue;
+			// A -> α.Bβ, a
+			// B -> γ, b where b ∈ first(βa)
+			first.clear();
+			first.resize(grammar.symbol_count());
+			bool empty = builder.first_of_tail(production, dot + 2, first);
+			for (auto& t : builder.closure_template(production[dot + 1])) {
+				auto& item = m_items[positions.at(t.production)];
+				// update lookaheads generated spontaneously
+				item.lookaheads().union_with(t.lookaheads.row());
+				if (t.propagate) {
+					item.lookaheads().union_with(first.row());
+					// if β is empty, link the item back to the kernel
+					if (empty && pool != nullptr) {
+						auto new_node = pool->allocate();
+						new_node->next = item.backward_plink();
+						item.backward_plink() = new_node;
+						new_node->item = &kernel;
+					}
+				}
+			}
+		}
+	}
+
+	Action& ItemSet::add_action(const Symbol& symbol, ActionType type, std::size_t value) const {
+		auto& res = m_actions.emplace(symbol.index(), Action {type, value});
+		Action& act = res.first->second;
+		if (!res.second) {
+			// a conflict has occurred
+			if (type == ActionType::SHIFT) {
+				if (act.type == ActionType::SHIFT) {
+					act.type = ActionType::SSCONFLICT;
+				}
+			}
+			else if (type == ActionType::REDUCE) {
+				if (act.type == ActionType::SHIFT) {
+					act.type = ActionType::SRCONFLICT;
+				}
+				else if (act.type == ActionType::REDUCE) {
+					act.type = ActionType::RRCONFLICT;
+				}
+			}
+		}
+		return act;
+	}
+
+	Action ItemSet::evaluate(const Symbol& symbol) const {
+		auto& find = m_actions.find(symbol.index());
+		if (find != m_actions.end()) {
+			return find->second;
+		}
+		return Action {ActionType::ERROR, 0};
+	}
+
+	void ItemSet::sort() {
+		std::sort(m_items.begin(), m_items.begin() + m_kernel_count, [](auto& a, auto& b) {
+			if (a.production_id() != b.production_id()) {
+				return a.production_id() < b.production_id();
+			}
+			else {
+				return a.dot() < b.dot();
+			}
+		});
+	}
+
+	void ItemSet::reset() {
+		m_items.clear();
+		m_kernel_count = 0;
+		m_lookaheads.clear();
+		m_actions.clear();
+		m_successors.clear();
+	}
+
+	void ItemSet::reopen() {
+		m_items.erase(m_items.begin() + m_kernel_count, m_items.end());
+		for (auto& kernel : m_items) {
+			kernel.forward_plink() = nullptr;
+			kernel.lookaheads() = SymbolRow {};
+		}
+		m_lookaheads.clear();
+		m_actions.clear();
+		m_successors.clear();
+	}
+
+	bool operator==(const ItemSet& a, const ItemSet& b) {
+		// sort kernels so that the order does not matter here
+		return a.m_kernel_count == b.m_kernel_count
+			&& std::equal(a.m_items.begin(), a.m_items.begin() + a.m_kernel_count, b.m_items.begin());
+	}
+
+	std::size_t hash_value(const ItemSet& set) {
+		// sort kernels so that the order does not matter here
+		return boost::hash_range(set.m_items.begin(), set.m_items.begin() + set.m_kernel_count);
+	}
+
 }
\ No newline at end of file
@@ -1,90 +1,111 @@
-#pragma once
-
-#include "Item.h"
-#include "Action.h"
-
-#include <vector>
-#include <unordered_set>
-#include <unordered_map>
-
-#include <boost\functional\hash\hash.hpp>
-
-namespace pitaya {
-
-	using StateID = std::size_t;
-
-	class Production;
-	class Grammar;
-
-	/*!
-		\ingroup SA
-		ItemSet class.
-	*/
-	class ItemSet {
-
-	public:
-
-		friend class ItemSetBuilder;
-
-		//! Constructor.
-		ItemSet();
-
-		//! Move constructor.
-		ItemSet(ItemSet&&) noexcept;
-
-		//! ID of the set(or state).
-		StateID id() const;
-
-		//! Add a kernel to the set.
-		/*!
-			\return The added kernel.
-		*/
-		Item& add_kernel(const Production&, Item::Dot = 0);
-
-		//! Compute the closure of kernels.
-		void compute_closure(Grammar&, ItemSetBuilder&);
-
-		//! Sort the kernels.
-		void sort();
-
-		//! Add an action.
-		/*!
-			\return The added action(a conflict may have occurred).
-		*/
-		Action& add_action(const Symbol&, ActionType, std::size_t value) const;
-
-		//! Evaluate the action against a symbol.
-		Action evaluate(const Symbol&) const;
-
-		//! Clear all items.
-		void reset();
-
-		//! Two ItemSets are equal iff they have the same kernels.
-		friend bool operator==(const ItemSet&, const ItemSet&);
-
-		//! Hash.
-		friend std::size_t hash_value(const ItemSet&);
-
-	private:
-
-		//! All kernels in this set.
-		std::vector<Item> m_kernels;
-		//! Closure of this set.
-		std::unordered_set<Item, boost::hash<Item>> m_closure;
-
-		StateID m_id;		//!< ID of the set(or state).
-
-		//! Actions of this state.
-		mutable std::unordered_map<std::size_t, Action> m_actions;
-
-		/// @cond
-		//! Unique ID marking the first appearance of an item-set(or state).
-		static std::size_t order() {
-			static std::size_t interned_ = 0;
-			return interned_++;
-		}
-		/// @endcond
-
-	};
-
+#pragma once
+
+#include "Item.h"
+#include "Action.h"
+
+#include <vector>
+#include <unordered_map>
+
+#include <boost\functional\hash\hash.hpp>
+
+namespace pitaya {
+
+	using StateID = std::size_t;
+
+	class Production;
+	class Grammar;
+
+	/*!
+		\ingroup SA
+		ItemSet class.
+	*/
+	class ItemSet {
+
+	public:
+
+		friend class ItemSetBuilder;
+		friend class ParseTable;
+
+		//! Constructor.
+		ItemSet();
+
+		//! Move constructor.
+		ItemSet(ItemSet&&) noexcept;
+
+		//! ID of the set(or state).
+		StateID id() const;
+
+		//! Add a kernel to the set.
+		/*!
+			\return The added kernel.
+		*/
+		Item& add_kernel(const Production&, Item::Dot = 0);
+
+		//! Compute the closure of kernels.
+		/*!
+			Closure items are appended after the kernels,
+			then the lookaheads of all items are allocated at once.
+			Each closure item gets the lookaheads generated spontaneously,
+			and a backward propagation link to every kernel whose context reaches it.
+		*/
+		void compute_closure(Grammar&, const ItemSetBuilder&, PLinkPool&);
+
+		//! Add the lookaheads generated spontaneously inside the closure again.
+		/*!
+			The closure must have been computed, and no link is added.
+			Items whose lookaheads are final already are left as they are.
+		*/
+		void regenerate_lookaheads(Grammar&, const ItemSetBuilder&) const;
+
+		//! Drop the closure, lookaheads, actions and successors.
+		/*!
+			Kernels are kept with their backward propagation links, so that the closure can be computed again.
+		*/
+		void reopen();
+
+		//! Sort the kernels.
+		void sort();
+
+		//! Add an action.
+		/*!
+			\return The added action(a conflict may have occurred).
+		*/
+		Action& add_action(const Symbol&, ActionType, std::size_t value) const;
+
+		//! Evaluate the action against a symbol.
+		Action evaluate(const Symbol&) const;
+
+		//! Clear all items.
+		void reset();
+
+		//! Two ItemSets are equal iff they have the same kernels.
+		friend bool operator==(const ItemSet&, const ItemSet&);
+
+		//! Hash.
+		friend std::size_t hash_value(const ItemSet&);
+
+	private:
+
+		//! All items in this set, kernels first.
+		std::vector<Item> m_items;
+		//! Number of kernels.
+		std::size_t m_kernel_count;
+		//! Lookaheads of all items, a row of words per item.
+		std::vector<SymbolRow::Word> m_lookaheads;
+
+		StateID m_id;		//!< ID of the set(or state), assigned by the builder.
+
+		//! Actions of this state.
+		mutable std::unordered_map<std::size_t, Action> m_actions;
+
+		//! Successors in order of first appearance, kept for ItemSetBuilder::update().
+		std::vector<std::pair<const Symbol*, ItemSet*>> m_successors;
+
+		/// @cond
+		void generate_lookaheads(Grammar&, const ItemSetBuilder&,
+								 const std::unordered_map<ProductionID, std::size_t>& positions, PLinkPool*) const;
+		/// @endcond
+
+	};
+
 }
\ No newline at end of file
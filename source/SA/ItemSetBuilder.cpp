@@ -1,367 +1,1009 @@
-#include "ItemSetBuilder.h"
-
-#include <cassert>
-#include <fstream>
-#include <iostream>
-#include <iomanip>
-#include <regex>
-
-namespace pitaya {
-
-	ItemSetBuilder::ItemSetBuilder(Grammar& grammar)
-		: m_grammar {grammar}, m_item_sets {}, m_curr_item_set {},
-		m_plinks {}, m_conflict_count {} {}
-
-	ItemSetBuilder::~ItemSetBuilder() {
-		for (auto& p : m_plinks) {
-			delete p;
-		}
-	}
-
-	void ItemSetBuilder::build() {
-		compute_first_sets();
-		// initial item-set
-		m_curr_item_set.reset();
-		// assume the first production is the augmented one
-		// it's the only kernel for initial state
-		auto& add = m_curr_item_set.add_kernel(m_grammar.get_production(0));
-		// add '$' to the kernel's lookaheads
-		add.lookaheads().resize(m_grammar.symbol_count());
-		add.lookaheads().add(m_grammar.endmark());
-		build_item_set();
-		fill_lookaheads();
-		fill_actions();
-	}
-
-	void ItemSetBuilder::compute_first_sets() {
-		for (auto it = m_grammar.nonterminal_begin(); it != m_grammar.nonterminal_end(); it++) {
-			(*it)->first_set().resize(m_grammar.symbol_count());
-		}
-
-		auto progress = 0;
-		do {
-			progress = 0;
-			for (ProductionID pid = 0; pid < m_grammar.production_count(); pid++) {
-				auto& p = m_grammar.get_production(pid);
-				auto& lhs = p[0];
-				for (std::size_t i = 0; i < p.rhs_count(); i++) {
-					auto& rhs = p[i + 1];
-					if (rhs.type() != SymbolType::NONTERMINAL) {
-						if (lhs.first_set().add(rhs)) {
-							progress++;
-						}
-						break;		// encounter a (multi)terminal, add to first set and stop
-					}
-					else if (lhs == rhs) {
-						if (!lhs.lambda()) break;	// recurrence happened, should compute in another production
-					}
-					else {
-						if (lhs.first_set().union_with(rhs.first_set())) {
-							progress++;
-						}
-						if (!rhs.lambda()) break;	// stop if a rhs cannot generate empty string
-					}
-				}
-			}
-		} while (progress != 0);
-	}
-
-	const ItemSet& ItemSetBuilder::build_item_set() {
-		m_curr_item_set.sort();		// sort kernels for hashing and comparing
-		auto& find = m_item_sets.find(m_curr_item_set);
-		if (find != m_item_sets.end()) {
-			// a set with the same kernels already exists
-			// copy all the backward propagation links
-			for (auto& from_item : m_curr_item_set.m_kernels) {
-				auto& res = find->m_closure.find(from_item);
-				// the closure must have been computed
-				assert(res != find->m_closure.end());
-				auto from = from_item.backward_plink();
-				auto* to = &(res->backward_plink());
-				PLinkNode* next;
-				while (from != nullptr) {
-					next = from->next;
-					from->next = *to;
-					*to = from;
-					from = next;
-				}
-				from_item.backward_plink() = nullptr;
-			}
-			m_curr_item_set.reset();
-			return *find;
-		}
-		// a new item-set
-		// compute closure before moving
-		m_curr_item_set.compute_closure(m_grammar, *this);
-		// 'move' the currently building set into the new set
-		auto& new_item = m_item_sets.emplace(std::move(m_curr_item_set)).first;
-		// compute successors
-		build_successors(*new_item);
-		return *new_item;
-	}
-
-	void ItemSetBuilder::build_successors(const ItemSet& set) {
-		// reset
-		for (auto& item : set.m_closure) item.complete = false;
-
-		for (auto& item : set.m_closure) {
-			if (item.complete) continue;
-			auto& production = m_grammar.get_production(item.production_id());
-			auto dot = item.dot();
-			// skip item whose dot is at right end
-			if (dot >= production.rhs_count()) {
-				item.complete = true;
-				continue;
-			}
-			auto& symbol = production[dot + 1];		// symbol after dot
-			// for each item which has 'symbol' after its dot
-			for (auto& item2 : set.m_closure) {
-				if (item2.complete) continue;
-				auto& production2 = m_grammar.get_production(item2.production_id());
-				auto dot2 = item2.dot();
-				if (dot2 >= production2.rhs_count()) {
-					// 'item2' has no successor
-					item2.complete = true;
-					continue;
-				}
-				auto& symbol2 = production2[dot2 + 1];			// symbol after dot
-				if (symbol == symbol2) {
-					// each item becomes complete after contibuting a successor
-					item2.complete = true;
-					auto& add = m_curr_item_set.add_kernel(production2, dot2 + 1);
-					add.lookaheads().resize(m_grammar.symbol_count());
-					// add backward propagation link
-					auto& new_node = new_link();
-					new_node->next = add.backward_plink();
-					add.backward_plink() = new_node;
-					new_node->item = &item2;
-				}
-			}
-			// build set from new kernels
-			auto& new_set = build_item_set();
-			if (symbol.type() == SymbolType::NONTERMINAL) {
-				auto& act = set.add_action(symbol, ActionType::GOTO, new_set.id());
-			}
-			else {
-				auto& act = set.add_action(symbol, ActionType::SHIFT, new_set.id());
-				assert(act.type != ActionType::SSCONFLICT);
-			}
-		}
-	}
-
-	void ItemSetBuilder::fill_lookaheads() {
-		// convert all backward links into forward links
-		for (auto& set : m_item_sets) {
-			for (auto& item : set.m_closure) {
-				for (auto bpl = item.backward_plink(); bpl != nullptr; bpl = bpl->next) {
-					auto& fpl = bpl->item->forward_plink();
-					auto& new_node = new_link();
-					new_node->next = fpl;
-					fpl = new_node;
-					new_node->item = &item;
-				}
-			}
-		}
-
-		// reset
-		for (auto& set : m_item_sets) {
-			for (auto& item : set.m_closure) {
-				item.complete = false;
-			}
-		}
-
-		bool not_fin = false;
-		do {
-			not_fin = false;
-			for (auto& set : m_item_sets) {
-				for (auto& item : set.m_closure) {
-					if (item.complete) continue;
-					for (auto fpl = item.forward_plink(); fpl != nullptr; fpl = fpl->next) {
-						bool change = fpl->item->lookaheads().union_with(item.lookaheads());
-						if (change) {
-							fpl->item->complete = false;
-							not_fin = true;
-						}
-					}
-					item.complete = true;
-				}
-			}
-		} while (not_fin);
-	}
-
-	void ItemSetBuilder::fill_actions() {
-		for (auto& state : m_item_sets) {
-			m_sorted.emplace(state.m_id, &state);
-			for (auto& item : state.m_closure) {
-				auto& production = m_grammar.get_production(item.production_id());
-				// for every production whose dot is at right end
-				if (item.dot() == production.rhs_count()) {
-					for (auto it = m_grammar.symbol_begin(); it != m_grammar.symbol_end(); it++) {
-						if (item.lookaheads()[**it]) {
-							if (production.id() == 0) {
-								state.add_action(**it, ActionType::ACCEPT, production.id());
-							}
-							else {
-								Action new_act {ActionType::REDUCE, production.id()};
-								auto& act = state.add_action(**it, new_act.type, new_act.value);
-								resolve_conflict(act, new_act, **it, state);
-							}
-						}
-					}
-				}
-			}
-		}
-	}
-
-	bool ItemSetBuilder::resolve_conflict(Action& origin, Action& conflict,
-										  const Symbol& sym, const ItemSet& state) {
-		static auto first_time = true;
-		static auto mode = std::ios::trunc;
-		if (first_time) {
-			first_time = false;
-		}
-		else {
-			mode = std::ios::app;
-		}
-
-		std::ofstream file;
-		file.open("report\\conflicts", mode);
-		// TODO use precedence and associativity to resolve conflicts
-		if (origin.type == ActionType::SRCONFLICT) {
-			m_conflict_count++;
-			// simply discard SHIFT
-			origin.type = ActionType::REDUCE;
-			origin.value = conflict.value;
-			if (file.is_open()) {
-				file << "[ SRCONFLICT in " << state.m_id << " ]\n"
-					<< '\t' << sym << '\n'
-					<< '\t' << m_grammar.get_production(conflict.value) << '\n'
-					<< "resolved to\t" << m_grammar.get_production(conflict.value) << "\n\n";
-			}
-			m_conflict_count--;
-			return true;
-		}
-		else if (origin.type == ActionType::RRCONFLICT) {
-			m_conflict_count++;
-			auto p1 = &m_grammar.get_production(origin.value);
-			auto p2 = &m_grammar.get_production(conflict.value);
-			auto p3 = p1;
-			// resolve to the one whose rank is higher
-			if (p1->rank() < p2->rank()) {
-				origin.value = conflict.value;
-				p3 = p2;
-			}
-			origin.type = ActionType::REDUCE;
-			if (file.is_open()) {
-				file << "[ RRCONFLICT in " << state.m_id << " ]\n"
-					<< '\t' << *p1 << '\n'
-					<< '\t' << *p2 << '\n'
-					<< "resolved to\t" << *p3 << "\n\n";
-			}
-			m_conflict_count--;
-			return true;
-		}
-		file.close();
-		return true;
-	}
-
-	const ItemSet& ItemSetBuilder::get_state(StateID id) const {
-		return *m_sorted.at(id);
-	}
-
-	PLinkNode*& ItemSetBuilder::new_link() {
-		m_plinks.push_back(new PLinkNode {});
-		return m_plinks.back();
-	}
-
-	void ItemSetBuilder::report(bool graph) const {
-		std::ofstream file, gfile;
-		file.open("report\\lalr_states", std::ios::trunc);
-		if (graph) {
-			gfile.open("report\\graph\\lalr.dot", std::ios::trunc);
-		}
-		if (file.is_open()) {
-			if (gfile.is_open()) {
-				gfile << "digraph lalr_graph {\n" << "node [shape=record];\n";
-			}
-			std::string dot = "[>";
-			for (auto& p : m_sorted) {
-				auto& state = *p.second;
-				file << "[state " << state.m_id << "]\n";
-				std::string gitems;
-				for (auto& item : state.m_closure) {
-					if (!item.is_kernel()) continue;
-					auto& p = m_grammar.get_production(item.production_id());
-					std::string pstr(p[0].name());
-					pstr.append(" ==> ");
-					for (std::size_t i = 0; i <= p.rhs_count(); i++) {
-						if (i == item.dot()) {
-							pstr.append(dot);
-						}
-						if (i < p.rhs_count()) {
-							pstr.append(p[i + 1].name()).append(" ");
-						}
-					}
-					file << ">\t" << std::setw(20) << pstr << "\n\t\t";
-
-					std::string lookaheads;
-					auto cols = 4, col = 0;
-					for (auto it = m_grammar.symbol_begin(); it != m_grammar.symbol_end(); it++) {
-						if (item.lookaheads()[**it]) {
-							file << **it << "\t";
-							lookaheads.append((**it).name()).append(" ");
-							if (++col == cols) {
-								col = 0;
-								lookaheads.append("\\n");
-							}
-						}
-					}
-					file << "\n";
-
-					std::regex re("[|<>{}]");
-					pstr = std::regex_replace(pstr, re, "\\$&");
-					lookaheads = std::regex_replace(lookaheads, re, "\\$&");
-					gitems.append("{ ").append(pstr).append(" | ")
-						.append(lookaheads).append("}|");
-				}
-				file << '\n';
-				if (gfile.is_open()) {
-					if (gitems.size() > 0) {
-						// remove the last '|'
-						gitems.erase(gitems.size() - 1);
-					}
-					gfile << state.m_id << " [label=\"" << state.m_id << "|{"
-						<< gitems << "}\"];\n";
-				}
-
-				for (auto& action : state.m_actions) {
-					file << ">\t" << std::setw(30)
-						<< std::left << m_grammar.get_symbol(action.first)
-						<< std::right << action.second.type;
-					if (action.second.type == ActionType::SHIFT
-						|| action.second.type == ActionType::GOTO) {
-						file << std::setw(10) << "[ state " << action.second.value << " ]";
-						if (gfile.is_open()) {
-							gfile << state.m_id << " -> " << action.second.value
-								<< " [label=\"" << m_grammar.get_symbol(action.first) << "\"];\n";
-						}
-					}
-					else if (action.second.type == ActionType::REDUCE) {
-						file << std::setw(10) << "[ " << m_grammar.get_production(action.second.value) << " ]";
-					}
-					file << '\n';
-				}
-				file << '\n';
-			}
-			file << "Total conflicts: " << m_conflict_count << '\n';
-			if (gfile.is_open()) {
-				gfile << "}\n";
-			}
-		}
-		file.close();
-		if (graph) {
-			gfile.close();
-		}
-	}
-
+#include "ItemSetBuilder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+namespace pitaya {
+
+	namespace {
+
+		// call f(i, t) for every i in [0, n) on at most 'threads' threads
+		// t is the index of the calling thread, 0 is the current one
+		template<typename F>
+		void parallel_for(std::size_t n, std::size_t threads, F f) {
+			if (threads <= 1 || n <= 1) {
+				for (std::size_t i = 0; i < n; i++) {
+					f(i, 0);
+				}
+				return;
+			}
+			std::atomic<std::size_t> next {0};
+			auto work = [&](std::size_t t) {
+				for (auto i = next++; i < n; i = next++) {
+					f(i, t);
+				}
+			};
+			std::vector<std::thread> pool;
+			for (std::size_t t = 1; t < std::min(threads, n); t++) {
+				pool.emplace_back(work, t);
+			}
+			work(0);
+			for (auto& thread : pool) {
+				thread.join();
+			}
+		}
+
+	}
+
+	ItemSetBuilder::ItemSetBuilder(Grammar& grammar)
+		: m_grammar {grammar}, m_shards {}, m_sorted {}, m_threads {1},
+		m_plinks {}, m_conflict_count {}, m_conflicts {}, m_bypasses {}, m_templates {}, m_last_productions {} {}
+
+	void ItemSetBuilder::build(std::size_t threads) {
+		compute_first_sets(std::vector<bool>(m_grammar.symbol_count(), true));
+		compute_closure_templates();
+		build_automaton(threads);
+	}
+
+	void ItemSetBuilder::update(std::size_t threads) {
+		if (m_templates.empty()) {
+			// nothing to start from
+			build(threads);
+			return;
+		}
+
+		// a production is kept if the one of the same rank has the same symbols,
+		// a replaced production keeps its rank but counts as removed and added
+		auto n = m_grammar.symbol_count();
+		std::unordered_map<Rank, ProductionID> ids;
+		for (ProductionID pid = 0; pid < m_grammar.production_count(); pid++) {
+			ids.emplace(m_grammar.get_production(pid).rank(), pid);
+		}
+		const auto none = ProductionID(-1);
+		std::vector<ProductionID> kept(m_last_productions.size(), none);		// new ids of the last productions
+		std::vector<bool> added(m_grammar.production_count(), true);
+		// nonterminals which have lost or gained productions
+		std::vector<bool> changed(n, false);
+		for (ProductionID last = 0; last < m_last_productions.size(); last++) {
+			auto& symbols = m_last_productions[last].second;
+			auto find = ids.find(m_last_productions[last].first);
+			if (find != ids.end()) {
+				auto& p = m_grammar.get_production(find->second);
+				bool same = p.rhs_count() + 1 == symbols.size();
+				for (std::size_t i = 0; i <= p.rhs_count() && same; i++) {
+					same = p[i].index() == symbols[i];
+				}
+				if (same) {
+					kept[last] = find->second;
+					added[find->second] = false;
+					continue;
+				}
+			}
+			changed[symbols[0]] = true;
+		}
+		for (ProductionID pid = 0; pid < m_grammar.production_count(); pid++) {
+			if (added[pid]) {
+				changed[m_grammar.get_production(pid)[0].index()] = true;
+			}
+		}
+
+		// the first set and lambda of a nonterminal may change iff it reaches a changed one through rhs
+		std::vector<std::vector<std::size_t>> users(n);
+		for (ProductionID pid = 0; pid < m_grammar.production_count(); pid++) {
+			auto& p = m_grammar.get_production(pid);
+			for (std::size_t i = 1; i <= p.rhs_count(); i++) {
+				if (p[i].type() == SymbolType::NONTERMINAL) {
+					users[p[i].index()].push_back(p[0].index());
+				}
+			}
+		}
+		auto affected = changed;
+		std::vector<std::size_t> worklist;
+		for (std::size_t i = 0; i < n; i++) {
+			if (changed[i]) {
+				worklist.push_back(i);
+			}
+		}
+		while (!worklist.empty()) {
+			auto index = worklist.back();
+			worklist.pop_back();
+			for (auto user : users[index]) {
+				if (!affected[user]) {
+					affected[user] = true;
+					worklist.push_back(user);
+				}
+			}
+		}
+		compute_first_sets(affected);
+
+		// a template is computed again if any of its items is removed, belongs to a changed nonterminal,
+		// or has an affected rhs, otherwise its items are only renumbered
+		std::vector<bool> recomputed(n, false);
+		for (auto it = m_grammar.nonterminal_begin(); it != m_grammar.nonterminal_end(); it++) {
+			bool dirty = false;
+			for (auto& t : m_templates[it->index()]) {
+				if (kept[t.production] == none) {
+					dirty = true;
+					break;
+				}
+				t.production = kept[t.production];
+				auto& p = m_grammar.get_production(t.production);
+				dirty = changed[p[0].index()];
+				for (std::size_t i = 1; i <= p.rhs_count() && !dirty; i++) {
+					dirty = affected[p[i].index()];
+				}
+				if (dirty) break;
+			}
+			if (dirty) {
+				compute_closure_template(*it);
+				recomputed[it->index()] = true;
+			}
+		}
+
+		set_threads(threads);
+		m_conflict_count = 0;
+		m_conflicts.clear();
+		m_bypasses.clear();
+
+		// an item-set is kept if all its items are kept, none of them reaches a changed nonterminal,
+		// and its kernels close over the same templates with the same first sets of their tails
+		// an item-set is reopened if only its kernels are kept, and dropped otherwise
+		auto keeps = [&](const ItemSet& set, bool& closure) {
+			closure = true;
+			for (std::size_t i = 0; i < set.m_items.size(); i++) {
+				auto& item = set.m_items[i];
+				if (kept[item.production_id()] == none) {
+					if (i < set.m_kernel_count) return false;
+					closure = false;
+					continue;
+				}
+				auto& p = m_grammar.get_production(kept[item.production_id()]);
+				if (item.dot() >= p.rhs_count() || p[item.dot() + 1].type() != SymbolType::NONTERMINAL) continue;
+				auto& symbol = p[item.dot() + 1];
+				closure = closure && !changed[symbol.index()];
+				if (i < set.m_kernel_count) {
+					closure = closure && !recomputed[symbol.index()];
+					for (auto j = item.dot() + 2; j <= p.rhs_count() && closure; j++) {
+						closure = !affected[p[j].index()];
+					}
+				}
+			}
+			return true;
+		};
+
+		// links from reopened and dropped item-sets are unlinked from their successors,
+		// and the kernels having lost links get their lookaheads computed again
+		std::vector<std::pair<ItemSet*, std::size_t>> seeds;
+		auto unlink = [&seeds](const ItemSet& from) {
+			std::less<const Item*> less;
+			auto begin = from.m_items.data(), end = begin + from.m_items.size();
+			for (auto& s : from.m_successors) {
+				auto& to = *s.second;
+				for (std::size_t i = 0; i < to.m_kernel_count; i++) {
+					bool lost = false;
+					for (auto link = &to.m_items[i].backward_plink(); *link != nullptr;) {
+						if (!less((*link)->item, begin) && less((*link)->item, end)) {
+							*link = (*link)->next;
+							lost = true;
+						}
+						else {
+							link = &(*link)->next;
+						}
+					}
+					if (lost) {
+						seeds.emplace_back(&to, i);
+					}
+				}
+			}
+		};
+
+		std::vector<std::unique_ptr<ItemSet>> sets, dropped;
+		for (auto& shard : m_shards) {
+			shard.sets.clear();
+			for (auto& set : shard.owned) {
+				sets.push_back(std::move(set));
+			}
+			shard.owned.clear();
+		}
+		std::vector<bool> closure(sets.size());
+		for (std::size_t i = 0; i < sets.size(); i++) {
+			bool c;
+			if (!keeps(*sets[i], c)) {
+				unlink(*sets[i]);
+				dropped.push_back(std::move(sets[i]));
+				continue;
+			}
+			closure[i] = c;
+			if (!c) {
+				unlink(*sets[i]);
+			}
+		}
+		// renumber productions, and put the item-sets back by their new hashes
+		for (std::size_t i = 0; i < sets.size(); i++) {
+			if (sets[i] == nullptr) continue;
+			auto& set = *sets[i];
+			if (!closure[i]) {
+				set.reopen();
+			}
+			for (auto& item : set.m_items) {
+				item.rebase(kept[item.production_id()]);
+			}
+			set.m_id = 0;
+			auto& shard = m_shards[(hash_value(set) >> 8) % SHARD_COUNT];
+			shard.sets.insert(sets[i].get());
+			shard.owned.push_back(std::move(sets[i]));
+		}
+		for (auto& set : dropped) {
+			set->m_id = 0;
+		}
+
+		m_plinks.resize(std::max(m_plinks.size(), m_threads));
+		auto opened = explore();
+
+		// item-sets no longer reachable are dropped too
+		for (auto& shard : m_shards) {
+			for (auto& set : shard.owned) {
+				if (set->m_id != 0) continue;
+				unlink(*set);
+				shard.sets.erase(set.get());
+				dropped.push_back(std::move(set));
+			}
+			shard.owned.erase(std::remove(shard.owned.begin(), shard.owned.end(), nullptr), shard.owned.end());
+		}
+
+		// copy the live links into new pools, which drops the unlinked ones for good
+		// every item is marked complete, i.e. its lookaheads are final, for now
+		std::vector<PLinkPool> pools(m_threads);
+		for (auto& p : m_sorted) {
+			for (auto& item : p.second->m_items) {
+				auto link = &item.backward_plink();
+				for (auto bpl = *link; bpl != nullptr; bpl = bpl->next) {
+					*link = pools[0].allocate();
+					(*link)->item = bpl->item;
+					link = &(*link)->next;
+				}
+				*link = nullptr;
+				item.forward_plink() = nullptr;
+				item.complete = true;
+			}
+		}
+		m_plinks = std::move(pools);
+		link_forward();
+
+		// the region whose lookaheads are computed again: items reached from the seeds,
+		// which are kernels having lost links, and all items of opened item-sets
+		std::vector<const Item*> stack;
+		for (auto& seed : seeds) {
+			if (seed.first->m_id != 0) {
+				stack.push_back(&seed.first->m_items[seed.second]);
+			}
+		}
+		for (auto set : opened) {
+			for (auto& item : set->m_items) {
+				stack.push_back(&item);
+			}
+		}
+		// seeds in dropped item-sets are skipped above, so they can go now
+		dropped.clear();
+		while (!stack.empty()) {
+			auto item = stack.back();
+			stack.pop_back();
+			if (!item->complete) continue;
+			item->complete = false;
+			for (auto fpl = item->forward_plink(); fpl != nullptr; fpl = fpl->next) {
+				stack.push_back(fpl->item);
+			}
+		}
+
+		// items of the region in kept item-sets start over from the lookaheads generated spontaneously,
+		// opened ones have nothing else yet
+		std::unordered_set<const ItemSet*> fresh(opened.begin(), opened.end());
+		for (auto& p : m_sorted) {
+			auto& set = *p.second;
+			if (fresh.count(&set) != 0) continue;
+			bool reset = false;
+			for (auto& item : set.m_items) {
+				if (!item.complete) {
+					item.lookaheads().clear();
+					reset = true;
+				}
+			}
+			if (reset) {
+				set.regenerate_lookaheads(m_grammar, *this);
+				if (set.m_id == 1) {
+					set.m_items.front().lookaheads().add(m_grammar.endmark());
+				}
+			}
+		}
+
+		// propagate from the region, and into it from the items linked to it
+		std::deque<const Item*> queue;
+		std::unordered_set<const Item*> sources;
+		for (auto& p : m_sorted) {
+			for (auto& item : p.second->m_items) {
+				if (item.complete) continue;
+				queue.push_back(&item);
+				for (auto bpl = item.backward_plink(); bpl != nullptr; bpl = bpl->next) {
+					if (bpl->item->complete && sources.insert(bpl->item).second) {
+						queue.push_back(bpl->item);
+					}
+				}
+			}
+		}
+		propagate_lookaheads(std::move(queue));
+		fill_actions();
+		remember_productions();
+	}
+
+	void ItemSetBuilder::build_automaton(std::size_t threads) {
+		set_threads(threads);
+		// start over if built before
+		for (auto& shard : m_shards) {
+			shard.sets.clear();
+			shard.owned.clear();
+		}
+		m_plinks.clear();
+		m_plinks.resize(m_threads);
+		m_conflict_count = 0;
+		m_conflicts.clear();
+		m_bypasses.clear();
+
+		explore();
+		fill_lookaheads();
+		fill_actions();
+		remember_productions();
+	}
+
+	std::vector<ItemSet*> ItemSetBuilder::explore() {
+		m_sorted.clear();
+		std::vector<ItemSet*> opened;
+
+		// initial item-set
+		// assume the first production is the augmented one
+		// it's the only kernel for initial state
+		auto initial_set = std::make_unique<ItemSet>();
+		initial_set->add_kernel(m_grammar.get_production(0));
+		auto initial = intern(std::move(initial_set));
+		StateID count = 1;
+		initial->m_id = count;
+		m_sorted.emplace(initial->m_id, initial);
+		// an item-set without lookaheads is yet to be closed
+		if (initial->m_lookaheads.empty()) {
+			initial->compute_closure(m_grammar, *this, m_plinks[0]);
+			// add '$' to the kernel's lookaheads
+			initial->m_items.front().lookaheads().add(m_grammar.endmark());
+			opened.push_back(initial);
+		}
+
+		// breadth first, a level at a time
+		// every set in the frontier has its closure computed, and its successors unless it is kept as it is
+		std::vector<ItemSet*> frontier {initial};
+		std::vector<bool> open {!opened.empty()};
+		while (!frontier.empty()) {
+			parallel_for(frontier.size(), m_threads, [&](std::size_t i, std::size_t t) {
+				if (open[i]) {
+					frontier[i]->m_successors = build_successors(*frontier[i], m_plinks[t]);
+				}
+			});
+
+			// number new sets in a fixed order, and add transitions
+			std::vector<ItemSet*> next;
+			std::vector<bool> next_open;
+			for (std::size_t i = 0; i < frontier.size(); i++) {
+				// a new table rather than a cleared one, so actions are listed in the order build() adds them
+				frontier[i]->m_actions = std::unordered_map<std::size_t, Action> {};
+				for (auto& s : frontier[i]->m_successors) {
+					auto& symbol = *s.first;
+					auto target = s.second;
+					if (target->m_id == 0) {
+						target->m_id = ++count;
+						m_sorted.emplace(target->m_id, target);
+						next.push_back(target);
+						next_open.push_back(target->m_lookaheads.empty());
+					}
+					if (symbol.type() == SymbolType::NONTERMINAL) {
+						frontier[i]->add_action(symbol, ActionType::GOTO, target->id());
+					}
+					else {
+						auto& act = frontier[i]->add_action(symbol, ActionType::SHIFT, target->id());
+						assert(act.type != ActionType::SSCONFLICT);
+					}
+				}
+			}
+
+			parallel_for(next.size(), m_threads, [&](std::size_t i, std::size_t t) {
+				if (next_open[i]) {
+					next[i]->compute_closure(m_grammar, *this, m_plinks[t]);
+				}
+			});
+			for (std::size_t i = 0; i < next.size(); i++) {
+				if (next_open[i]) {
+					opened.push_back(next[i]);
+				}
+			}
+			frontier = std::move(next);
+			open = std::move(next_open);
+		}
+		return opened;
+	}
+
+	void ItemSetBuilder::set_threads(std::size_t threads) {
+		if (threads == 0) {
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		m_threads = threads;
+	}
+
+	void ItemSetBuilder::remember_productions() {
+		m_last_productions.clear();
+		for (ProductionID pid = 0; pid < m_grammar.production_count(); pid++) {
+			auto& p = m_grammar.get_production(pid);
+			m_last_productions.emplace_back(p.rank(), std::vector<std::size_t> {});
+			for (std::size_t i = 0; i <= p.rhs_count(); i++) {
+				m_last_productions.back().second.push_back(p[i].index());
+			}
+		}
+	}
+
+	void ItemSetBuilder::compute_first_sets(const std::vector<bool>& dirty) {
+		auto n = m_grammar.symbol_count();
+		for (auto it = m_grammar.nonterminal_begin(); it != m_grammar.nonterminal_end(); it++) {
+			if (dirty[it->index()]) {
+				it->first_set().clear();
+				it->first_set().resize(n);
+			}
+		}
+
+		// A depends on B if B follows a lambda prefix in a production of A
+		// (multi)terminals there are added at once, and so are first sets of clean nonterminals
+		std::vector<std::vector<std::size_t>> depends(n);
+		for (ProductionID pid = 0; pid < m_grammar.production_count(); pid++) {
+			auto& p = m_grammar.get_production(pid);
+			auto& lhs = p[0];
+			if (!dirty[lhs.index()]) continue;		// others are final already
+			for (std::size_t i = 0; i < p.rhs_count(); i++) {
+				auto& rhs = p[i + 1];
+				if (rhs.type() != SymbolType::NONTERMINAL) {
+					lhs.first_set().add(rhs);
+					break;		// encounter a (multi)terminal, add to first set and stop
+				}
+				if (!dirty[rhs.index()]) {
+					lhs.first_set().union_with(rhs.first_set());
+				}
+				else if (lhs != rhs) {
+					depends[lhs.index()].push_back(rhs.index());
+				}
+				if (!rhs.lambda()) break;		// stop if a rhs cannot generate empty string
+			}
+		}
+
+		// nonterminals of a strongly connected component share one first set,
+		// and Tarjan's algorithm completes a component after all it depends on
+		const auto none = std::size_t(-1);
+		std::vector<std::size_t> order(n, none), low(n), stack, members;
+		std::vector<bool> on_stack(n, false);
+		std::vector<std::pair<std::size_t, std::size_t>> path;		// nodes being visited with their next dependency
+		std::size_t count = 0;
+		auto visit = [&](std::size_t v) {
+			order[v] = low[v] = count++;
+			stack.push_back(v);
+			on_stack[v] = true;
+			path.emplace_back(v, 0);
+		};
+		for (auto it = m_grammar.nonterminal_begin(); it != m_grammar.nonterminal_end(); it++) {
+			if (!dirty[it->index()] || order[it->index()] != none) continue;
+			visit(it->index());
+			while (!path.empty()) {
+				auto v = path.back().first;
+				if (path.back().second < depends[v].size()) {
+					auto w = depends[v][path.back().second++];
+					if (order[w] == none) {
+						visit(w);
+					}
+					else if (on_stack[w]) {
+						low[v] = std::min(low[v], order[w]);
+					}
+					continue;
+				}
+				path.pop_back();
+				if (!path.empty()) {
+					auto u = path.back().first;
+					low[u] = std::min(low[u], low[v]);
+				}
+				if (low[v] != order[v]) continue;
+
+				// v is the root of a component, collect it into v's first set
+				members.clear();
+				std::size_t w;
+				do {
+					w = stack.back();
+					stack.pop_back();
+					on_stack[w] = false;
+					members.push_back(w);
+				} while (w != v);
+				auto& first = m_grammar.get_symbol(v).first_set();
+				for (auto m : members) {
+					first.union_with(m_grammar.get_symbol(m).first_set());
+					for (auto d : depends[m]) {
+						first.union_with(m_grammar.get_symbol(d).first_set());
+					}
+				}
+				for (auto m : members) {
+					if (m != v) {
+						m_grammar.get_symbol(m).first_set().union_with(first);
+					}
+				}
+			}
+		}
+	}
+
+	void ItemSetBuilder::compute_closure_templates() {
+		m_templates.assign(m_grammar.symbol_count(), {});
+		for (auto it = m_grammar.nonterminal_begin(); it != m_grammar.nonterminal_end(); it++) {
+			compute_closure_template(*it);
+		}
+	}
+
+	void ItemSetBuilder::compute_closure_template(const Symbol& symbol) {
+		SymbolSet first;
+		auto& items = m_templates[symbol.index()];
+		items.clear();
+		std::unordered_map<ProductionID, std::size_t> positions;
+		// position of the item of a production, add it if absent
+		auto position = [&](ProductionID pid, bool& added) {
+			auto res = positions.emplace(pid, items.size());
+			if (res.second) {
+				items.push_back(TemplateItem {pid, SymbolSet {}, false});
+				items.back().lookaheads.resize(m_grammar.symbol_count());
+				added = true;
+			}
+			return res.first->second;
+		};
+
+		// productions of the nonterminal itself get the whole context
+		bool progress = false;
+		auto range = m_grammar.productions_by_lhs(symbol);
+		for (auto pid = range.first; pid <= range.second; pid++) {
+			items[position(pid, progress)].propagate = true;
+		}
+		// C -> .Dδ, b
+		// D -> .γ, c where c ∈ first(δb)
+		do {
+			progress = false;
+			for (std::size_t i = 0; i < items.size(); i++) {
+				auto& p = m_grammar.get_production(items[i].production);
+				if (p.rhs_count() == 0 || p[1].type() != SymbolType::NONTERMINAL) continue;
+				first.clear();
+				first.resize(m_grammar.symbol_count());
+				bool empty = first_of_tail(p, 2, first);
+				auto r = m_grammar.productions_by_lhs(p[1]);
+				for (auto pid = r.first; pid <= r.second; pid++) {
+					// 'items' may grow, so access by positions only
+					auto j = position(pid, progress);
+					progress |= items[j].lookaheads.union_with(first);
+					if (empty) {
+						progress |= items[j].lookaheads.union_with(items[i].lookaheads);
+						if (items[i].propagate && !items[j].propagate) {
+							items[j].propagate = true;
+							progress = true;
+						}
+					}
+				}
+			}
+		} while (progress);
+	}
+
+	const std::vector<ItemSetBuilder::TemplateItem>& ItemSetBuilder::closure_template(const Symbol& symbol) const {
+		return m_templates[symbol.index()];
+	}
+
+	bool ItemSetBuilder::first_of_tail(const Production& p, std::size_t from, SymbolSet& first) const {
+		for (auto i = from; i <= p.rhs_count(); i++) {
+			auto& rhs = p[i];
+			if (rhs.type() != SymbolType::NONTERMINAL) {
+				first.add(rhs);
+				return false;
+			}
+			first.union_with(rhs.first_set());
+			if (!rhs.lambda()) return false;
+		}
+		return true;
+	}
+
+	std::size_t ItemSetBuilder::SetHash::operator()(const ItemSet* set) const {
+		return hash_value(*set);
+	}
+
+	bool ItemSetBuilder::SetEqual::operator()(const ItemSet* a, const ItemSet* b) const {
+		return *a == *b;
+	}
+
+	ItemSet* ItemSetBuilder::intern(std::unique_ptr<ItemSet> set) {
+		set->sort();		// sort kernels for hashing and comparing
+		auto& shard = m_shards[(hash_value(*set) >> 8) % SHARD_COUNT];
+		std::lock_guard<std::mutex> lock {shard.mutex};
+		auto& find = shard.sets.find(set.get());
+		if (find != shard.sets.end()) {
+			// a set with the same kernels already exists
+			// copy all the backward propagation links
+			// both kernels are sorted, so they match by position
+			for (std::size_t i = 0; i < set->m_kernel_count; i++) {
+				auto& from_item = set->m_items[i];
+				auto from = from_item.backward_plink();
+				auto* to = &((*find)->m_items[i].backward_plink());
+				PLinkNode* next;
+				while (from != nullptr) {
+					next = from->next;
+					from->next = *to;
+					*to = from;
+					from = next;
+				}
+				from_item.backward_plink() = nullptr;
+			}
+			return *find;
+		}
+		// a new item-set
+		shard.owned.push_back(std::move(set));
+		shard.sets.insert(shard.owned.back().get());
+		return shard.owned.back().get();
+	}
+
+	std::vector<std::pair<const Symbol*, ItemSet*>> ItemSetBuilder::build_successors(const ItemSet& set, PLinkPool& pool) {
+		// group items by the symbol after their dots, in order of first appearance
+		// items whose dots are at right end have no successor
+		std::vector<std::size_t> bucket_of(m_grammar.symbol_count(), 0);
+		std::vector<const Symbol*> symbols;
+		std::vector<std::vector<const Item*>> buckets;
+		for (auto& item : set.m_items) {
+			auto& production = m_grammar.get_production(item.production_id());
+			auto dot = item.dot();
+			if (dot >= production.rhs_count()) continue;
+			auto& symbol = production[dot + 1];		// symbol after dot
+			auto& bucket = bucket_of[symbol.index()];
+			if (bucket == 0) {
+				symbols.push_back(&symbol);
+				buckets.emplace_back();
+				bucket = buckets.size();
+			}
+			buckets[bucket - 1].push_back(&item);
+		}
+
+		std::vector<std::pair<const Symbol*, ItemSet*>> successors;
+		for (std::size_t b = 0; b < buckets.size(); b++) {
+			auto new_set = std::make_unique<ItemSet>();
+			// each item having the symbol after its dot contributes a kernel
+			for (auto item : buckets[b]) {
+				auto& production = m_grammar.get_production(item->production_id());
+				auto& add = new_set->add_kernel(production, item->dot() + 1);
+				// add backward propagation link
+				auto new_node = pool.allocate();
+				new_node->next = add.backward_plink();
+				add.backward_plink() = new_node;
+				new_node->item = item;
+			}
+			successors.emplace_back(symbols[b], intern(std::move(new_set)));
+		}
+		return successors;
+	}
+
+	void ItemSetBuilder::fill_lookaheads() {
+		link_forward();
+
+		// an item is queued iff it is not complete
+		std::deque<const Item*> worklist;
+		for (auto& p : m_sorted) {
+			for (auto& item : p.second->m_items) {
+				item.complete = false;
+				worklist.push_back(&item);
+			}
+		}
+		propagate_lookaheads(std::move(worklist));
+	}
+
+	void ItemSetBuilder::link_forward() {
+		// convert all backward links into forward links
+		for (auto& p : m_sorted) {
+			for (auto& item : p.second->m_items) {
+				for (auto bpl = item.backward_plink(); bpl != nullptr; bpl = bpl->next) {
+					auto& fpl = bpl->item->forward_plink();
+					auto new_node = new_link();
+					new_node->next = fpl;
+					fpl = new_node;
+					new_node->item = &item;
+				}
+			}
+		}
+	}
+
+	void ItemSetBuilder::propagate_lookaheads(std::deque<const Item*> worklist) {
+		// an item is queued again only when its lookaheads grow
+		while (!worklist.empty()) {
+			auto& item = *worklist.front();
+			worklist.pop_front();
+			item.complete = true;
+			for (auto fpl = item.forward_plink(); fpl != nullptr; fpl = fpl->next) {
+				bool change = fpl->item->lookaheads().union_with(item.lookaheads());
+				if (change && fpl->item->complete) {
+					fpl->item->complete = false;
+					worklist.push_back(fpl->item);
+				}
+			}
+		}
+	}
+
+	void ItemSetBuilder::fill_actions() {
+		// states are independent, log their conflicts separately
+		std::vector<const ItemSet*> states;
+		for (auto& p : m_sorted) {
+			states.push_back(p.second);
+		}
+		std::vector<std::string> logs(states.size());
+		parallel_for(states.size(), m_threads, [&](std::size_t s, std::size_t) {
+			auto& state = *states[s];
+			std::ostringstream log;
+			for (auto& item : state.m_items) {
+				auto& production = m_grammar.get_production(item.production_id());
+				// for every production whose dot is at right end
+				if (item.dot() == production.rhs_count()) {
+					auto& lookaheads = item.lookaheads();
+					for (auto i = lookaheads.find_first(); i != SymbolSet::npos; i = lookaheads.find_next(i)) {
+						auto& symbol = m_grammar.get_symbol(i);
+						if (production.id() == 0) {
+							state.add_action(symbol, ActionType::ACCEPT, production.id());
+						}
+						else {
+							Action new_act {ActionType::REDUCE, production.id()};
+							auto& act = state.add_action(symbol, new_act.type, new_act.value);
+							resolve_conflict(act, new_act, symbol, state, log);
+						}
+					}
+				}
+			}
+			logs[s] = log.str();
+		});
+
+		// kept until report(), builders of other grammars may run meanwhile
+		for (auto& log : logs) {
+			m_conflicts += log;
+		}
+	}
+
+	bool ItemSetBuilder::resolve_conflict(Action& origin, Action& conflict,
+										  const Symbol& sym, const ItemSet& state, std::ostream& log) {
+		if (origin.type == ActionType::SRCONFLICT) {
+			auto& production = m_grammar.get_production(conflict.value);
+			log << "[ SRCONFLICT in " << state.m_id << " ]\n"
+				<< '\t' << sym << '\n'
+				<< '\t' << production << '\n';
+			// the precedence of a production is that of its last (multi)terminal
+			// only symbols declared by %left, %right or %none have one
+			const Symbol* last = nullptr;
+			for (auto i = production.rhs_count(); i > 0 && last == nullptr; i--) {
+				if (production[i].type() != SymbolType::NONTERMINAL) {
+					last = &production[i];
+				}
+			}
+			if (last == nullptr || last->associativity() == Associativity::UNDEFINED
+				|| sym.associativity() == Associativity::UNDEFINED) {
+				// simply discard SHIFT
+				m_conflict_count++;
+				origin.type = ActionType::REDUCE;
+				origin.value = conflict.value;
+				log << "resolved to\t" << production << "\n\n";
+				return false;
+			}
+			// higher precedence wins, and on a tie the associativity of the lookahead decides
+			if (last->precedence() > sym.precedence()
+				|| (last->precedence() == sym.precedence() && sym.associativity() == Associativity::LEFT)) {
+				origin.type = ActionType::REDUCE;
+				origin.value = conflict.value;
+			}
+			else if (last->precedence() < sym.precedence()
+					 || sym.associativity() == Associativity::RIGHT) {
+				origin.type = ActionType::SHIFT;
+			}
+			else {
+				// nonassociative, e.g. a == b == c
+				origin.type = ActionType::ERROR;
+				origin.value = Action::EXPLICIT_ERROR;
+			}
+			log << "resolved by precedence to\t" << origin.type << "\n\n";
+			return true;
+		}
+		else if (origin.type == ActionType::RRCONFLICT) {
+			m_conflict_count++;
+			auto p1 = &m_grammar.get_production(origin.value);
+			auto p2 = &m_grammar.get_production(conflict.value);
+			auto p3 = p1;
+			// resolve to the one whose rank is higher
+			if (p1->rank() < p2->rank()) {
+				origin.value = conflict.value;
+				p3 = p2;
+			}
+			origin.type = ActionType::REDUCE;
+			log << "[ RRCONFLICT in " << state.m_id << " ]\n"
+				<< '\t' << *p1 << '\n'
+				<< '\t' << *p2 << '\n'
+				<< "resolved to\t" << *p3 << "\n\n";
+			return false;
+		}
+		return true;
+	}
+
+	std::size_t ItemSetBuilder::bypass_unit_reductions() {
+		// the unit production a state does nothing but reduce, or nullptr
+		auto unit_of = [this](const ItemSet& state) -> const Production* {
+			const Production* unit = nullptr;
+			for (auto& a : state.m_actions) {
+				if (a.second.type != ActionType::REDUCE) return nullptr;
+				auto& p = m_grammar.get_production(a.second.value);
+				if (p.rhs_count() != 1 || (unit != nullptr && unit != &p)) return nullptr;
+				unit = &p;
+			}
+			return unit;
+		};
+
+		// targets are found on the original gotos first, so every chain is logged in full
+		struct Bypass {
+			Action* action;
+			StateID target;
+			std::vector<const Production*> chain;
+		};
+		std::ostringstream log;
+		std::size_t count = 0;
+		for (auto& p : m_sorted) {
+			auto& state = *p.second;
+			std::map<std::size_t, Bypass> bypasses;		// by symbol index, for a stable log
+			for (auto& a : state.m_actions) {
+				if (a.second.type != ActionType::GOTO) continue;
+				Bypass bypass {&a.second, a.second.value, {}};
+				// a cycle of unit productions, which is ambiguous, must not loop forever
+				while (bypass.chain.size() < m_sorted.size()) {
+					auto unit = unit_of(get_state(bypass.target));
+					if (unit == nullptr) break;
+					auto find = state.m_actions.find((*unit)[0].index());
+					if (find == state.m_actions.end() || find->second.type != ActionType::GOTO) break;
+					bypass.chain.push_back(unit);
+					bypass.target = find->second.value;
+				}
+				if (!bypass.chain.empty()) {
+					bypasses.emplace(a.first, std::move(bypass));
+				}
+			}
+			for (auto& b : bypasses) {
+				auto& bypass = b.second;
+				log << "[ GOTO in " << state.m_id << " ]\n"
+					<< '\t' << m_grammar.get_symbol(b.first) << '\t' << bypass.action->value << " -> " << bypass.target << '\n';
+				for (auto unit : bypass.chain) {
+					log << '\t' << *unit << '\n';
+				}
+				log << '\n';
+				bypass.action->value = bypass.target;
+				count++;
+			}
+		}
+		m_bypasses = log.str();
+		return count;
+	}
+
+	const ItemSet& ItemSetBuilder::get_state(StateID id) const {
+		return *m_sorted.at(id);
+	}
+
+	PLinkNode* ItemSetBuilder::new_link() {
+		return m_plinks.front().allocate();
+	}
+
+	void ItemSetBuilder::report(bool graph) const {
+		std::ofstream cfile;
+		cfile.open("report\\conflicts", std::ios::trunc);
+		if (cfile.is_open()) {
+			cfile << m_conflicts;
+		}
+		cfile.close();
+
+		std::ofstream bfile;
+		bfile.open("report\\unit_reductions", std::ios::trunc);
+		if (bfile.is_open()) {
+			bfile << m_bypasses;
+		}
+		bfile.close();
+
+		std::ofstream file, gfile;
+		file.open("report\\lalr_states", std::ios::trunc);
+		if (graph) {
+			gfile.open("report\\graph\\lalr.dot", std::ios::trunc);
+		}
+		if (file.is_open()) {
+			if (gfile.is_open()) {
+				gfile << "digraph lalr_graph {\n" << "node [shape=record];\n";
+			}
+			std::string dot = "[>";
+			for (auto& p : m_sorted) {
+				auto& state = *p.second;
+				file << "[state " << state.m_id << "]\n";
+				std::string gitems;
+				for (auto& item : state.m_items) {
+					if (!item.is_kernel()) continue;
+					auto& p = m_grammar.get_production(item.production_id());
+					std::string pstr(p[0].name());
+					pstr.append(" ==> ");
+					for (std::size_t i = 0; i <= p.rhs_count(); i++) {
+						if (i == item.dot()) {
+							pstr.append(dot);
+						}
+						if (i < p.rhs_count()) {
+							pstr.append(p[i + 1].name()).append(" ");
+						}
+					}
+					file << ">\t" << std::setw(20) << pstr << "\n\t\t";
+
+					std::string lookaheads;
+					auto cols = 4, col = 0;
+					auto& set = item.lookaheads();
+					for (auto i = set.find_first(); i != SymbolSet::npos; i = set.find_next(i)) {
+						auto& symbol = m_grammar.get_symbol(i);
+						file << symbol << "\t";
+						lookaheads.append(symbol.name()).append(" ");
+						if (++col == cols) {
+							col = 0;
+							lookaheads.append("\\n");
+						}
+					}
+					file << "\n";
+
+					std::regex re("[|<>{}]");
+					pstr = std::regex_replace(pstr, re, "\\$&");
+					lookaheads = std::regex_replace(lookaheads, re, "\\$&");
+					gitems.append("{ ").append(pstr).append(" | ")
+						.append(lookaheads).append("}|");
+				}
+				file << '\n';
+				if (gfile.is_open()) {
+					if (gitems.size() > 0) {
+						// remove the last '|'
+						gitems.erase(gitems.size() - 1);
+					}
+					gfile << state.m_id << " [label=\"" << state.m_id << "|{"
+						<< gitems << "}\"];\n";
+				}
+
+				for (auto& action : state.m_actions) {
+					file << ">\t" << std::setw(30)
+						<< std::left << m_grammar.get_symbol(action.first)
+						<< std::right << action.second.type;
+					if (action.second.type == ActionType::SHIFT
+						|| action.second.type == ActionType::GOTO) {
+						file << std::setw(10) << "[ state " << action.second.value << " ]";
+						if (gfile.is_open()) {
+							gfile << state.m_id << " -> " << action.second.value
+								<< " [label=\"" << m_grammar.get_symbol(action.first) << "\"];\n";
+						}
+					}
+					else if (action.second.type == ActionType::REDUCE) {
+						file << std::setw(10) << "[ " << m_grammar.get_production(action.second.value) << " ]";
+					}
+					file << '\n';
+				}
+				file << '\n';
+			}
+			file << "Total conflicts: " << m_conflict_count << '\n';
+			if (gfile.is_open()) {
+				gfile << "}\n";
+			}
+		}
+		file.close();
+		if (graph) {
+			gfile.close();
+		}
+	}
+
 }
\ No newline at end of file
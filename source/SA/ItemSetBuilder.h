@@ -1,70 +1,209 @@
-#pragma once
-
-#include <unordered_set>
-#include <map>
-
-#include "Grammar.h"
-#include "ItemSet.h"
-
-namespace pitaya {
-
-	/*!
-		\ingroup SA
-		ItemSetBuilder class.
-	*/
-	class ItemSetBuilder {
-
-	public:
-
-		//! Constructor.
-		ItemSetBuilder(Grammar&);
-
-		//! Destructor.
-		~ItemSetBuilder();
-
-		//! Build all item sets.
-		void build();
-
-		//! Get a state by id.
-		const ItemSet& get_state(StateID) const;
-
-		//! Get a new PLinkNode.
-		PLinkNode*& new_link();
-
-		//! Generate report file.
-		void report(bool graph) const;
-
-	private:
-
-		Grammar& m_grammar;		//!< The grammar this builder works on.
-
-		std::unordered_set<ItemSet, boost::hash<ItemSet>> m_item_sets;	//!< All ItemSets.
-		std::map<StateID, const ItemSet*> m_sorted;		//!< Sorted item-sets for quick access.
-		ItemSet m_curr_item_set;		//!< The ItemSet being built currently.
-
-		std::vector<PLinkNode*> m_plinks;		//!< Maintain all PLinkNodes.
-
-		std::size_t m_conflict_count;			//!< Number of conflicts.
-
-		//! Compute the first sets of every nonterminal.
-		void compute_first_sets();
-
-		//! Build or merge item-set according to m_curr_item_set.
-		const ItemSet& build_item_set();
-
-		//! Build all successors of an item-set.
-		void build_successors(const ItemSet&);
-
-		//! Compute all lookaheads.
-		void fill_lookaheads();
-
-		//! Generate all actions.
-		void fill_actions();
-
-		//! Try resolving a conflict.
-		bool resolve_conflict(Action& origin, Action& conflict,
-							  const Symbol&, const ItemSet&);
-
-	};
-
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+
+#include "Grammar.h"
+#include "ItemSet.h"
+
+namespace pitaya {
+
+	/*!
+		\ingroup SA
+		ItemSetBuilder class.
+	*/
+	class ItemSetBuilder {
+
+	public:
+
+		friend class ParseTable;
+
+		//! Item of a closure template.
+		struct TemplateItem {
+
+			ProductionID production;	//!< Production of the item, whose dot is at left end.
+			SymbolSet lookaheads;		//!< Lookaheads generated spontaneously inside the closure.
+			bool propagate;				//!< Whether the context of the closure reaches the item.
+
+		};
+
+		//! Constructor.
+		ItemSetBuilder(Grammar&);
+
+		//! Build all item sets.
+		/*!
+			The LR(0) automaton is built breadth first, a level of item-sets at a time.
+			Closures and successors of a level are computed concurrently,
+			and new item-sets are numbered in the order a single thread would find them,
+			so the result does not depend on the number of threads.
+			\param threads Number of threads, 0 for one per hardware thread.
+		*/
+		void build(std::size_t threads = 1);
+
+		//! Build again after productions of the grammar have been edited.
+		/*!
+			Edits are found by comparing productions of the same rank with the last build.
+			First sets and closure templates are computed again only for the nonterminals the edits affect.
+			An item-set is kept as it is if none of its items is removed or reaches a changed nonterminal,
+			and its closure generates the same lookaheads, otherwise it is reopened, i.e. its closure
+			and successors are computed again, or dropped if a kernel is removed.
+			Lookaheads are propagated again only through the items reached from reopened and new item-sets,
+			or from kernels which have lost a link, others keep theirs.
+			Actions of all states are generated again, and states are numbered as build() would.
+			States of the last build, and parsers on them, are invalid afterwards.
+			\param threads As of build().
+		*/
+		void update(std::size_t threads = 1);
+
+		//! Bypass unit reductions by rewriting gotos.
+		/*!
+			A state doing nothing but reducing A -> B only leads back to the state it came from, to go on A.
+			So a goto on B into it is replaced by the goto on A, following chains of such states.
+			Parsers then skip these reductions, and their handlers see none of them,
+			so the skipped derivations are logged to the report instead.
+			Call it after build() or update(), which discard it.
+			\return Number of gotos rewritten.
+		*/
+		std::size_t bypass_unit_reductions();
+
+		//! Get a state by id.
+		const ItemSet& get_state(StateID) const;
+
+		//! Closure template of a nonterminal.
+		/*!
+			All items derived from the productions of a nonterminal B.
+			When an item A -> α.Bβ is closed, each template item gets its own lookaheads,
+			and if it propagates, first(β) and also the lookaheads of A -> α.Bβ when β can be empty.
+		*/
+		const std::vector<TemplateItem>& closure_template(const Symbol&) const;
+
+		//! First set of a tail of a production.
+		/*!
+			\param from Position of the first rhs of the tail.
+			\param first [out] The first set is added to it.
+			\return Whether the tail can generate an empty string.
+		*/
+		bool first_of_tail(const Production&, std::size_t from, SymbolSet& first) const;
+
+		//! Get a new PLinkNode.
+		PLinkNode* new_link();
+
+		//! Generate report file.
+		void report(bool graph) const;
+
+	private:
+
+		Grammar& m_grammar;		//!< The grammar this builder works on.
+
+		/// @cond
+		struct SetHash {
+			std::size_t operator()(const ItemSet*) const;
+		};
+		struct SetEqual {
+			bool operator()(const ItemSet*, const ItemSet*) const;
+		};
+		// a part of all item-sets guarded by its own mutex
+		struct Shard {
+			std::mutex mutex;
+			std::unordered_set<ItemSet*, SetHash, SetEqual> sets;
+			std::vector<std::unique_ptr<ItemSet>> owned;
+		};
+		static const std::size_t SHARD_COUNT = 64;
+		/// @endcond
+
+		std::array<Shard, SHARD_COUNT> m_shards;		//!< All ItemSets, sharded by hash.
+		std::map<StateID, const ItemSet*> m_sorted;		//!< Sorted item-sets for quick access.
+		std::size_t m_threads;					//!< Number of threads.
+
+		std::vector<PLinkPool> m_plinks;		//!< Maintain all PLinkNodes, a pool per thread.
+
+		std::atomic<std::size_t> m_conflict_count;	//!< Number of conflicts.
+		std::string m_conflicts;					//!< Log of conflicts, written by report().
+		std::string m_bypasses;						//!< Log of bypassed unit reductions, written by report().
+
+		//! Closure templates by symbol index, empty for (multi)terminals.
+		std::vector<std::vector<TemplateItem>> m_templates;
+
+		//! Rank and symbol indices(lhs followed by rhs) of every production by id, as of the last build.
+		std::vector<std::pair<Rank, std::vector<std::size_t>>> m_last_productions;
+
+		//! Compute the first sets of nonterminals.
+		/*!
+			\param dirty Nonterminals to compute by index, first sets of the others must be final.
+		*/
+		void compute_first_sets(const std::vector<bool>& dirty);
+
+		//! Compute the closure templates of every nonterminal.
+		void compute_closure_templates();
+
+		//! Compute the closure template of a nonterminal.
+		void compute_closure_template(const Symbol&);
+
+		//! Build the automaton, its lookaheads and actions, discarding any from before.
+		void build_automaton(std::size_t threads);
+
+		//! Set the number of threads, 0 for one per hardware thread.
+		void set_threads(std::size_t);
+
+		//! Remember the productions built from, for update().
+		void remember_productions();
+
+		//! Number all item-sets reachable from the initial one, breadth first.
+		/*!
+			Closures and successors are computed for item-sets without them,
+			others keep theirs. Transitions are added as actions of every state.
+			\return Item-sets whose closures have been computed.
+		*/
+		std::vector<ItemSet*> explore();
+
+		//! Find the item-set with the same kernels, or add it as a new one.
+		/*!
+			Backward propagation links of a found set's kernels are moved to the existing one.
+			Safe to call concurrently.
+			\return The item-set in the builder, whose id is 0 if it is new.
+		*/
+		ItemSet* intern(std::unique_ptr<ItemSet>);
+
+		//! Build all successors of an item-set.
+		/*!
+			\param pool Pool of the calling thread.
+			\return Pairs of the symbol and the successor on it, in order of first appearance.
+		*/
+		std::vector<std::pair<const Symbol*, ItemSet*>> build_successors(const ItemSet&, PLinkPool& pool);
+
+		//! Compute all lookaheads.
+		void fill_lookaheads();
+
+		//! Add a forward propagation link for every backward one.
+		void link_forward();
+
+		//! Propagate lookaheads along forward links until nothing changes.
+		/*!
+			\param worklist Items to start from, an item is queued again whenever its lookaheads grow after it is complete.
+		*/
+		void propagate_lookaheads(std::deque<const Item*> worklist);
+
+		//! Generate all actions.
+		void fill_actions();
+
+		//! Try resolving a conflict.
+		/*!
+			A shift-reduce conflict is resolved by the precedence and associativity
+			of the lookahead and of the last (multi)terminal of the production, as yacc does.
+			Without both it reduces, and a reduce-reduce conflict reduces the production ranking higher.
+			\param log Conflicts are reported to it.
+			\return Whether the conflict is resolved by precedence, otherwise it is counted.
+		*/
+		bool resolve_conflict(Action& origin, Action& conflict,
+							  const Symbol&, const ItemSet&, std::ostream& log);
+
+	};
+
 }
\ No newline at end of file
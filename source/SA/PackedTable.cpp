@@ -0,0 +1,194 @@
+#include "PackedTable.h"
+
+#include <algorithm>
+#include <map>
+#include <fstream>
+#include <iomanip>
+
+namespace pitaya {
+
+	const std::uint32_t PackedTable::FREE;
+
+	PackedTable::PackedTable(const ParseTable& table)
+		: m_table {table}, m_default_actions {}, m_default_gotos {},
+		m_action_base {}, m_goto_base {}, m_entries {}, m_check {} {
+		auto rows = table.state_count();
+		// a missing action; explicit errors differ from it, so they are kept as entries instead of taking the default
+		auto error = ParseTable::pack(ActionType::ERROR, 0);
+		std::vector<Vector> vectors;
+		std::vector<std::uint32_t*> bases;
+		m_action_base.resize(rows);
+		m_goto_base.resize(table.goto_width());
+
+		// the most frequent entry satisfying 'pred', or ERROR if none
+		auto most_frequent = [error](const std::vector<Entry>& entries, auto pred) {
+			std::map<Entry, std::size_t> counts;
+			auto best = error;
+			std::size_t best_count = 0;
+			for (auto e : entries) {
+				if (!pred(e)) continue;
+				auto count = ++counts[e];
+				if (count > best_count) {
+					best = e;
+					best_count = count;
+				}
+			}
+			return best;
+		};
+
+		// rows of the action table, keyed by column
+		// the most frequent reduction becomes the default action of a row
+		std::vector<Entry> line;
+		for (Row row = 0; row < rows; row++) {
+			line.clear();
+			for (Column column = 0; column < table.action_width(); column++) {
+				line.push_back(table.action(row, column));
+			}
+			auto def = most_frequent(line, [](Entry e) {
+				return ParseTable::type(e) == ActionType::REDUCE;
+			});
+			m_default_actions.push_back(def);
+			vectors.emplace_back();
+			for (Column column = 0; column < line.size(); column++) {
+				if (line[column] != error && line[column] != def) {
+					vectors.back().emplace_back(column, line[column]);
+				}
+			}
+		}
+
+		// columns of the goto table, keyed by row
+		// the most frequent state becomes the default goto of a column
+		for (Column column = 0; column < table.goto_width(); column++) {
+			line.clear();
+			for (Row row = 0; row < rows; row++) {
+				line.push_back(table.go(row, column));
+			}
+			auto def = most_frequent(line, [error](Entry e) {
+				return e != error;
+			});
+			m_default_gotos.push_back(def);
+			vectors.emplace_back();
+			for (Row row = 0; row < line.size(); row++) {
+				if (line[row] != error && line[row] != def) {
+					vectors.back().emplace_back(row, line[row]);
+				}
+			}
+		}
+
+		for (auto& base : m_action_base) bases.push_back(&base);
+		for (auto& base : m_goto_base) bases.push_back(&base);
+		pack(vectors, bases);
+	}
+
+	const ParseTable& PackedTable::table() const {
+		return m_table;
+	}
+
+	PackedTable::Entry PackedTable::action(Row row, Column column) const {
+		auto i = m_action_base[row] + column;
+		return m_check[i] == column ? m_entries[i] : m_default_actions[row];
+	}
+
+	PackedTable::Entry PackedTable::go(Row row, Column column) const {
+		auto i = m_goto_base[column] + row;
+		return m_check[i] == row ? m_entries[i] : m_default_gotos[column];
+	}
+
+	std::size_t PackedTable::raw_size() const {
+		auto cells = m_table.state_count() * (m_table.action_width() + m_table.goto_width());
+		return cells * sizeof(Entry);
+	}
+
+	std::size_t PackedTable::packed_size() const {
+		return (m_default_actions.size() + m_default_gotos.size() + m_entries.size()) * sizeof(Entry)
+			+ (m_action_base.size() + m_goto_base.size() + m_check.size()) * sizeof(std::uint32_t);
+	}
+
+	void PackedTable::report() const {
+		std::ofstream file;
+		file.open("report\\parse_table", std::ios::trunc);
+		if (file.is_open()) {
+			std::size_t used = 0;
+			for (auto key : m_check) {
+				if (key != FREE) used++;
+			}
+			file << std::left
+				<< std::setw(20) << "states" << m_table.state_count() << '\n'
+				<< std::setw(20) << "action columns" << m_table.action_width() << '\n'
+				<< std::setw(20) << "goto columns" << m_table.goto_width() << '\n'
+				<< std::setw(20) << "comb vector" << m_entries.size()
+				<< " (" << used << " used)\n"
+				<< std::setw(20) << "raw size" << raw_size() << " bytes\n"
+				<< std::setw(20) << "packed size" << packed_size() << " bytes\n";
+		}
+		file.close();
+	}
+
+	void PackedTable::pack(std::vector<Vector>& vectors, std::vector<std::uint32_t*>& bases) {
+		// place larger vectors first
+		std::vector<std::size_t> order;
+		for (std::size_t i = 0; i < vectors.size(); i++) {
+			order.push_back(i);
+		}
+		std::stable_sort(order.begin(), order.end(), [&vectors](auto a, auto b) {
+			return vectors[a].size() > vectors[b].size();
+		});
+
+		// two vectors may share a displacement only if they are identical
+		// otherwise an owner key could match a lookup of another vector
+		std::map<Vector, std::uint32_t> placed;
+		std::vector<bool> taken;
+		std::vector<std::size_t> empties;
+		std::size_t lowest = 0;		// the lowest free slot
+		for (auto i : order) {
+			auto& vector = vectors[i];
+			if (vector.empty()) {
+				empties.push_back(i);
+				continue;
+			}
+			auto find = placed.find(vector);
+			if (find != placed.end()) {
+				*bases[i] = find->second;
+				continue;
+			}
+			// first fit
+			std::size_t base = lowest > vector.front().first ? lowest - vector.front().first : 0;
+			for (;; base++) {
+				if (base < taken.size() && taken[base]) continue;
+				auto fit = std::all_of(vector.begin(), vector.end(), [this, base](auto& p) {
+					return base + p.first >= m_check.size() || m_check[base + p.first] == FREE;
+				});
+				if (fit) break;
+			}
+			if (base >= taken.size()) {
+				taken.resize(base + 1, false);
+			}
+			taken[base] = true;
+			for (auto& p : vector) {
+				auto slot = base + p.first;
+				if (slot >= m_check.size()) {
+					m_check.resize(slot + 1, FREE);
+					m_entries.resize(slot + 1, ParseTable::pack(ActionType::ERROR, 0));
+				}
+				m_check[slot] = p.first;
+				m_entries[slot] = p.second;
+			}
+			*bases[i] = std::uint32_t(base);
+			placed.emplace(vector, std::uint32_t(base));
+			while (lowest < m_check.size() && m_check[lowest] != FREE) {
+				lowest++;
+			}
+		}
+
+		// vectors without entries point past the used slots so that every lookup misses
+		auto end = m_check.size();
+		for (auto i : empties) {
+			*bases[i] = std::uint32_t(end);
+		}
+		// pad so that any displacement plus any key stays in range
+		auto keys = std::max(m_table.state_count(), m_table.action_width());
+		m_check.resize(end + keys, FREE);
+		m_entries.resize(end + keys, ParseTable::pack(ActionType::ERROR, 0));
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "ParseTable.h"
+
+namespace pitaya {
+
+	/*!
+		\ingroup SA
+		PackedTable class.
+
+		Compressed form of a ParseTable in the manner of yacc.
+		Every row keeps a default reduction and every goto column keeps a default state,
+		the remaining entries of all rows and goto columns are overlapped
+		into one comb vector by row displacement.
+	*/
+	class PackedTable {
+
+	public:
+
+		using Entry = ParseTable::Entry;
+		using Row = ParseTable::Row;
+		using Column = ParseTable::Column;
+
+		//! Constructor.
+		/*!
+			\param table The table to compress, it must outlive this one.
+		*/
+		PackedTable(const ParseTable& table);
+
+		//! The uncompressed table.
+		const ParseTable& table() const;
+
+		//! Action entry of a row.
+		/*!
+			An entry missing from the row yields the default reduction of the row.
+		*/
+		Entry action(Row, Column) const;
+
+		//! Goto entry of a row.
+		Entry go(Row, Column) const;
+
+		//! Size of the uncompressed tables in bytes.
+		std::size_t raw_size() const;
+
+		//! Size of the compressed tables in bytes.
+		std::size_t packed_size() const;
+
+		//! Generate report file.
+		void report() const;
+
+	private:
+
+		const ParseTable& m_table;				//!< The uncompressed table.
+
+		std::vector<Entry> m_default_actions;	//!< Default action of each row.
+		std::vector<Entry> m_default_gotos;		//!< Default goto of each goto column.
+		std::vector<std::uint32_t> m_action_base;	//!< Displacement of each row.
+		std::vector<std::uint32_t> m_goto_base;		//!< Displacement of each goto column.
+
+		std::vector<Entry> m_entries;			//!< The comb vector.
+		std::vector<std::uint32_t> m_check;		//!< Owner key of each slot in the comb vector.
+
+		/// @cond
+		// owner key of an unused slot
+		static const std::uint32_t FREE = std::uint32_t(-1);
+
+		using Vector = std::vector<std::pair<std::uint32_t, Entry>>;
+		void pack(std::vector<Vector>&, std::vector<std::uint32_t*>&);
+		/// @endcond
+
+	};
+
+}
\ No newline at end of file
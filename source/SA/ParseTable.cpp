@@ -0,0 +1,266 @@
+#include "ParseTable.h"
+#include "BinaryIO.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace pitaya {
+
+	const std::size_t ParseTable::npos;
+
+	ParseTable::ParseTable(Grammar& grammar, const ItemSetBuilder& builder)
+		: m_action_width {}, m_goto_width {}, m_actions {}, m_gotos {},
+		m_start {}, m_state_ids {}, m_columns {}, m_nonterminals {}, m_lhs {}, m_rhs_count {},
+		m_productions {}, m_production_offsets {}, m_names {}, m_indices {} {
+		// assign columns
+		// (multi)terminals go to the action table and nonterminals go to the goto table
+		for (auto it = grammar.symbol_begin(); it != grammar.symbol_end(); it++) {
+			auto& symbol = *it;
+			bool nonterminal = symbol.type() == SymbolType::NONTERMINAL;
+			m_columns.push_back(Column(nonterminal ? m_goto_width++ : m_action_width++));
+			m_nonterminals.push_back(nonterminal);
+			m_names.emplace_back(symbol.name());
+			m_indices.emplace(symbol.name(), symbol.index());
+		}
+
+		// assign rows
+		// the initial item-set has the smallest id
+		std::unordered_map<StateID, Row> rows;
+		for (auto& p : builder.m_sorted) {
+			rows.emplace(p.first, Row(m_state_ids.size()));
+			m_state_ids.push_back(p.first);
+		}
+		m_start = 0;
+
+		// fill tables
+		m_actions.resize(m_state_ids.size() * m_action_width, pack(ActionType::ERROR, 0));
+		m_gotos.resize(m_state_ids.size() * m_goto_width, pack(ActionType::ERROR, 0));
+		for (auto& p : builder.m_sorted) {
+			auto row = rows.at(p.first);
+			for (auto& a : p.second->m_actions) {
+				auto& action = a.second;
+				auto& symbol = grammar.get_symbol(a.first);
+				auto column = m_columns[symbol.index()];
+				switch (action.type) {
+					case ActionType::SHIFT:
+						m_actions[row * m_action_width + column] = pack(action.type, rows.at(action.value));
+						break;
+					case ActionType::GOTO:
+						m_gotos[row * m_goto_width + column] = pack(action.type, rows.at(action.value));
+						break;
+					case ActionType::REDUCE:
+					case ActionType::ACCEPT:
+					case ActionType::ERROR:
+						m_actions[row * m_action_width + column] = pack(action.type, action.value);
+						break;
+					default:
+						// conflicts must have been resolved
+						assert(false);
+						break;
+				}
+			}
+			// fold the multi-terminal fallback into the table
+			for (auto it = grammar.symbol_begin(); it != grammar.symbol_end(); it++) {
+				auto& symbol = *it;
+				if (symbol.type() != SymbolType::MULTITERMINAL) continue;
+				auto& entry = m_actions[row * m_action_width + m_columns[symbol.index()]];
+				// explicit errors of nonassociative operators are kept
+				if (type(entry) == ActionType::ERROR && !is_explicit_error(entry)) {
+					entry = m_actions[row * m_action_width + m_columns[symbol.shared_terminal().index()]];
+				}
+			}
+		}
+
+		// productions
+		for (ProductionID pid = 0; pid < grammar.production_count(); pid++) {
+			auto& production = grammar.get_production(pid);
+			m_lhs.push_back(m_columns[production[0].index()]);
+			m_rhs_count.push_back(std::uint32_t(production.rhs_count()));
+			m_production_offsets.push_back(m_productions.size());
+			for (std::size_t i = 0; i <= production.rhs_count(); i++) {
+				m_productions.push_back(std::uint32_t(production[i].index()));
+			}
+		}
+		m_production_offsets.push_back(m_productions.size());
+	}
+
+	ParseTable::ParseTable()
+		: m_action_width {}, m_goto_width {}, m_actions {}, m_gotos {},
+		m_start {}, m_state_ids {}, m_columns {}, m_nonterminals {}, m_lhs {}, m_rhs_count {},
+		m_productions {}, m_production_offsets {}, m_names {}, m_indices {} {}
+
+	std::unique_ptr<ParseTable> ParseTable::load(std::istream& is) {
+		BinaryReader reader {is};
+		std::unique_ptr<ParseTable> table {new ParseTable {}};
+		if (!reader.header("PRST")) return nullptr;
+		table->m_action_width = reader.word();
+		table->m_goto_width = reader.word();
+		table->m_start = reader.word();
+		table->m_actions = reader.words<Entry>();
+		table->m_gotos = reader.words<Entry>();
+		table->m_state_ids = reader.words<StateID>();
+		table->m_columns = reader.words<Column>();
+		table->m_nonterminals = reader.words<std::uint8_t>();
+		table->m_lhs = reader.words<Column>();
+		table->m_rhs_count = reader.words<std::uint32_t>();
+		table->m_productions = reader.words<std::uint32_t>();
+		table->m_production_offsets = reader.words<std::size_t>();
+		table->m_names = reader.strings();
+		if (!reader.good()) return nullptr;
+
+		// check the table is consistent before trusting any index
+		auto& t = *table;
+		auto rows = t.m_state_ids.size();
+		auto productions = t.m_lhs.size();
+		auto symbols = t.m_names.size();
+		if (t.m_actions.size() != rows * t.m_action_width || t.m_gotos.size() != rows * t.m_goto_width
+			|| t.m_start >= rows || t.m_columns.size() != symbols || t.m_nonterminals.size() != symbols
+			|| symbols == 0 || t.m_nonterminals[0]
+			|| t.m_rhs_count.size() != productions || t.m_production_offsets.size() != productions + 1
+			|| t.m_production_offsets.back() != t.m_productions.size()) {
+			return nullptr;
+		}
+		auto valid = [&](Entry entry) {
+			switch (type(entry)) {
+				case ActionType::SHIFT:
+				case ActionType::GOTO:
+					return value(entry) < rows;
+				case ActionType::REDUCE:
+				case ActionType::ACCEPT:
+					return value(entry) < productions;
+				case ActionType::ERROR:
+					return true;
+				default:
+					return false;
+			}
+		};
+		for (auto e : t.m_actions) {
+			if (!valid(e)) return nullptr;
+		}
+		for (auto e : t.m_gotos) {
+			if (!valid(e)) return nullptr;
+		}
+		// each column must fit the table of its own kind, the end-mark included
+		for (std::size_t i = 0; i < symbols; i++) {
+			if (t.m_columns[i] >= (t.m_nonterminals[i] ? t.m_goto_width : t.m_action_width)) return nullptr;
+		}
+		for (ProductionID pid = 0; pid < productions; pid++) {
+			auto begin = t.m_production_offsets[pid];
+			auto end = t.m_production_offsets[pid + 1];
+			if (t.m_lhs[pid] >= t.m_goto_width || begin >= end || end > t.m_productions.size()
+				|| end - begin != t.m_rhs_count[pid] + 1) {
+				return nullptr;
+			}
+		}
+		for (auto s : t.m_productions) {
+			if (s >= symbols) return nullptr;
+		}
+		for (std::size_t i = 0; i < symbols; i++) {
+			t.m_indices.emplace(t.m_names[i], i);
+		}
+		return table;
+	}
+
+	bool ParseTable::save(std::ostream& os) const {
+		BinaryWriter writer {os};
+		writer.header("PRST");
+		writer.word(std::uint32_t(m_action_width));
+		writer.word(std::uint32_t(m_goto_width));
+		writer.word(m_start);
+		writer.words(m_actions);
+		writer.words(m_gotos);
+		writer.words(m_state_ids);
+		writer.words(m_columns);
+		writer.words(m_nonterminals);
+		writer.words(m_lhs);
+		writer.words(m_rhs_count);
+		writer.words(m_productions);
+		writer.words(m_production_offsets);
+		writer.strings(m_names);
+		return writer.good();
+	}
+
+	std::size_t ParseTable::state_count() const {
+		return m_state_ids.size();
+	}
+
+	std::size_t ParseTable::action_width() const {
+		return m_action_width;
+	}
+
+	std::size_t ParseTable::goto_width() const {
+		return m_goto_width;
+	}
+
+	ParseTable::Row ParseTable::start() const {
+		return m_start;
+	}
+
+	ParseTable::Column ParseTable::endmark() const {
+		// the end-mark is always the first symbol
+		return m_columns[0];
+	}
+
+	ParseTable::Entry ParseTable::action(Row row, Column column) const {
+		return m_actions[row * m_action_width + column];
+	}
+
+	ParseTable::Entry ParseTable::go(Row row, Column column) const {
+		return m_gotos[row * m_goto_width + column];
+	}
+
+	std::size_t ParseTable::symbol(const std::string& name) const {
+		auto find = m_indices.find(name);
+		if (find != m_indices.end()) {
+			return find->second;
+		}
+		return npos;
+	}
+
+	ParseTable::Column ParseTable::column(std::size_t symbol) const {
+		return m_columns[symbol];
+	}
+
+	bool ParseTable::is_nonterminal(std::size_t symbol) const {
+		return m_nonterminals[symbol] != 0;
+	}
+
+	ParseTable::Column ParseTable::lhs(ProductionID pid) const {
+		return m_lhs[pid];
+	}
+
+	std::size_t ParseTable::rhs_count(ProductionID pid) const {
+		return m_rhs_count[pid];
+	}
+
+	StateID ParseTable::state_id(Row row) const {
+		return m_state_ids[row];
+	}
+
+	void ParseTable::print(std::ostream& os, ProductionID pid) const {
+		auto begin = m_production_offsets[pid];
+		auto end = m_production_offsets[pid + 1];
+		os << m_names[m_productions[begin]] << " ==> ";
+		for (auto i = begin + 1; i < end; i++) {
+			os << m_names[m_productions[i]] << " ";
+		}
+	}
+
+	ParseTable::Entry ParseTable::pack(ActionType type, std::size_t value) {
+		assert(value <= VALUE_MASK);
+		return (Entry(to_integral(type)) << TYPE_SHIFT) | Entry(value);
+	}
+
+	ActionType ParseTable::type(Entry entry) {
+		return static_cast<ActionType>(entry >> TYPE_SHIFT);
+	}
+
+	std::size_t ParseTable::value(Entry entry) {
+		return entry & VALUE_MASK;
+	}
+
+	bool ParseTable::is_explicit_error(Entry entry) {
+		return entry == pack(ActionType::ERROR, Action::EXPLICIT_ERROR);
+	}
+
+}
\ No newline at end of file
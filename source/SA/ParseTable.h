@@ -0,0 +1,149 @@
+#pragma once
+
+#include "ItemSetBuilder.h"
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+namespace pitaya {
+
+	/*!
+		\ingroup SA
+		ParseTable class.
+
+		Action and goto tables compiled from the item-sets of a built ItemSetBuilder.
+		States are renumbered into consecutive rows and both tables are stored state-major
+		in contiguous arrays of packed 32-bit entries.
+	*/
+	class ParseTable {
+
+	public:
+
+		friend class CodeGenerator;
+
+		using Entry = std::uint32_t;
+		using Row = std::uint32_t;
+		using Column = std::uint32_t;
+
+		//! Marks an undefined symbol or column.
+		static const std::size_t npos = std::size_t(-1);
+
+		//! Constructor.
+		/*!
+			\param builder A builder whose item-sets have been built.
+		*/
+		ParseTable(Grammar&, const ItemSetBuilder& builder);
+
+		//! Load a table written by save().
+		/*!
+			Neither a grammar nor a builder is needed.
+			\return nullptr if the data is malformed or of another format version.
+		*/
+		static std::unique_ptr<ParseTable> load(std::istream&);
+
+		//! Write the table in binary form.
+		/*!
+			\return Whether everything has been written.
+		*/
+		bool save(std::ostream&) const;
+
+		//! Number of rows(states).
+		std::size_t state_count() const;
+
+		//! Number of action columns.
+		std::size_t action_width() const;
+
+		//! Number of goto columns.
+		std::size_t goto_width() const;
+
+		//! Row of the initial state.
+		Row start() const;
+
+		//! Column of the end-mark symbol.
+		Column endmark() const;
+
+		//! Action entry of a row.
+		/*!
+			\param column Action column of a (multi)terminal.
+		*/
+		Entry action(Row, Column column) const;
+
+		//! Goto entry of a row.
+		/*!
+			\param column Goto column of a nonterminal.
+		*/
+		Entry go(Row, Column column) const;
+
+		//! Get a symbol index by name.
+		/*!
+			\return npos if the symbol is undefined.
+		*/
+		std::size_t symbol(const std::string&) const;
+
+		//! Action column of a (multi)terminal, or goto column of a nonterminal.
+		Column column(std::size_t symbol) const;
+
+		//! Whether a symbol is a nonterminal, i.e. its column is a goto column.
+		bool is_nonterminal(std::size_t symbol) const;
+
+		//! Goto column of the lhs of a production.
+		Column lhs(ProductionID) const;
+
+		//! Number of rhs of a production.
+		std::size_t rhs_count(ProductionID) const;
+
+		//! The original StateID of a row.
+		StateID state_id(Row) const;
+
+		//! Output a production in the same format as Production does.
+		void print(std::ostream&, ProductionID) const;
+
+		//! Pack an action into an entry.
+		static Entry pack(ActionType, std::size_t value);
+
+		//! Action type of an entry.
+		static ActionType type(Entry);
+
+		//! Row when type is SHIFT or GOTO, ProductionID when type is REDUCE.
+		static std::size_t value(Entry);
+
+		//! Whether an entry is an ERROR set on purpose, see Action::is_explicit_error().
+		static bool is_explicit_error(Entry);
+
+	private:
+
+		std::size_t m_action_width;				//!< Number of action columns.
+		std::size_t m_goto_width;				//!< Number of goto columns.
+		std::vector<Entry> m_actions;			//!< Action table, state-major.
+		std::vector<Entry> m_gotos;				//!< Goto table, state-major.
+
+		Row m_start;							//!< Row of the initial state.
+		std::vector<StateID> m_state_ids;		//!< Original StateIDs of rows.
+		std::vector<Column> m_columns;			//!< Columns of symbols.
+		std::vector<std::uint8_t> m_nonterminals;	//!< Whether symbols are nonterminals.
+
+		std::vector<Column> m_lhs;				//!< Goto columns of production lhs.
+		std::vector<std::uint32_t> m_rhs_count;	//!< Number of rhs of productions.
+
+		//! Symbol indices of all productions(lhs followed by rhs), used in output only.
+		std::vector<std::uint32_t> m_productions;
+		//! Offsets of productions in m_productions.
+		std::vector<std::size_t> m_production_offsets;
+
+		std::vector<std::string> m_names;		//!< Names of symbols.
+		std::unordered_map<std::string, std::size_t> m_indices;	//!< Symbol indices by name.
+
+		/// @cond
+		static const unsigned TYPE_SHIFT = 29;
+		static const Entry VALUE_MASK = (Entry(1) << TYPE_SHIFT) - 1;
+		ParseTable();
+		/// @endcond
+
+	};
+
+}
\ No newline at end of file
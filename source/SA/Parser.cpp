@@ -1,123 +1,229 @@
-#include "Parser.h"
-
-#include <cassert>
-#include <fstream>
-#include <iomanip>
-
-namespace pitaya {
-
-	Parser::Parser(Grammar& grammar, ItemSetBuilder& builder)
-		: m_grammar {grammar}, m_builder {builder} {}
-
-	bool Parser::parse(Tokenizer& tokenizer) {
-		std::ofstream file;
-		file.open("report\\parse", std::ios::trunc);
-
-		std::stack<StateID> state_stack {};
-		state_stack.push(1);
-		auto state = &m_builder.get_state(state_stack.top());
-		while (tokenizer.has_next()) {
-			auto& token = tokenizer.peek();
-			auto symbol = &m_grammar.get_symbol(token.type);
-			assert(*symbol != m_grammar.endmark());
-			auto action = state->evaluate(*symbol);
-			if (action.type == ActionType::ERROR) {
-				// fallback
-				if (symbol->type() == SymbolType::MULTITERMINAL) {
-					symbol = &symbol->shared_terminal();
-					action = state->evaluate(*symbol);
-				}
-			}
-			bool stop = evaluate(action, state_stack, tokenizer);
-			if (stop) {
-				bool error = action.type == ActionType::ERROR;
-				if (file.is_open()) {
-					if (error) {
-						file << "ERROR\n";
-					}
-					else {
-						file << "ACCEPT\n";
-					}
-				}
-				return error;
-			}
-			if (file.is_open()) {
-				if (action.type == ActionType::SHIFT) {
-					file << "SHIFT\t" << std::setw(21)
-						<< std::left << token.value
-						<< std::right << '(' << action.value << ")\n";
-				}
-				else if (action.type == ActionType::REDUCE) {
-					std::string s = "(" + std::to_string(state_stack.top()) + ")";
-					file << "REDUCE\t" << std::setw(20) << std::left
-						<< m_grammar.get_production(action.value)
-						<< std::setw(8) << std::right << s << '\n';
-				}
-			}
-			state = &m_builder.get_state(state_stack.top());
-		}
-		if (!tokenizer.has_next()) {
-			auto action = state->evaluate(m_grammar.endmark());
-			while (action.type != ActionType::ACCEPT) {
-				if (action.type == ActionType::ERROR) {
-					if (file.is_open()) {
-						file << "ERROR\n";
-					}
-					return false;
-				}
-				assert(action.type == ActionType::REDUCE);
-				if (file.is_open()) {
-					std::string s = "(" + std::to_string(state_stack.top()) + ")";
-					file << "REDUCE\t" << std::setw(20) << std::left
-						<< m_grammar.get_production(action.value)
-						<< std::setw(8) << std::right << s << '\n';
-				}
-				auto& p = m_grammar.get_production(action.value);
-				for (size_t i = 0; i < p.rhs_count(); i++) {
-					state_stack.pop();
-				}
-				auto& top = m_builder.get_state(state_stack.top());
-				auto act = top.evaluate(p[0]);
-				if (act.type == ActionType::ERROR) {
-					return false;
-				}
-				assert(act.type == ActionType::GOTO);
-				state_stack.push(act.value);
-				state = &m_builder.get_state(state_stack.top());
-				action = state->evaluate(m_grammar.endmark());
-			}
-			file << "ACCEPT\n";
-		}
-
-		file.close();
-		return true;
-	}
-
-	bool Parser::evaluate(Action& action, std::stack<StateID>& stack, Tokenizer& tokenizer) {
-		switch (action.type) {
-			case ActionType::SHIFT:
-				stack.push(action.value);
-				tokenizer.next();
-				break;
-			case ActionType::REDUCE:
-			{
-				auto& p = m_grammar.get_production(action.value);
-				for (size_t i = 0; i < p.rhs_count(); i++) {
-					stack.pop();
-				}
-				auto& top = m_builder.get_state(stack.top());
-				auto act = top.evaluate(p[0]);
-				assert(act.type == ActionType::GOTO);
-				stack.push(act.value);
-			}
-			break;
-			case ActionType::ACCEPT:
-			case ActionType::ERROR:
-				return true;
-			default:
-				break;
-		}
-		return false;
-	}
-
+#include "Parser.h"
+
+#include <cassert>
+#include <fstream>
+#include <iomanip>
+
+namespace pitaya {
+
+	Parser::Parser(Grammar& grammar, ItemSetBuilder& builder)
+		: m_grammar {&grammar}, m_builder {&builder}, m_table {nullptr}, m_packed {nullptr} {}
+
+	Parser::Parser(const ParseTable& table)
+		: m_grammar {nullptr}, m_builder {nullptr}, m_table {&table}, m_packed {nullptr} {}
+
+	Parser::Parser(const PackedTable& packed)
+		: m_grammar {nullptr}, m_builder {nullptr}, m_table {&packed.table()}, m_packed {&packed} {}
+
+	bool Parser::parse(Tokenizer& tokenizer, bool report) {
+		if (m_packed != nullptr) {
+			return drive(tokenizer, *m_packed, report);
+		}
+		if (m_table != nullptr) {
+			return drive(tokenizer, *m_table, report);
+		}
+
+		// every write below checks is_open(), so a closed file traces nothing
+		std::ofstream file;
+		if (report) {
+			file.open("report\\parse", std::ios::trunc);
+		}
+
+		// symbols of token types
+		std::vector<Symbol*> symbols;
+		for (std::size_t type = 0; type < tokenizer.type_count(); type++) {
+			symbols.push_back(&m_grammar->get_symbol(tokenizer.type_name(type)));
+		}
+
+		std::stack<StateID> state_stack {};
+		state_stack.push(1);
+		auto state = &m_builder->get_state(state_stack.top());
+		while (tokenizer.has_next()) {
+			auto& token = tokenizer.peek();
+			auto symbol = symbols[token.type];
+			assert(*symbol != m_grammar->endmark());
+			auto action = state->evaluate(*symbol);
+			if (action.type == ActionType::ERROR && !action.is_explicit_error()) {
+				// fallback, unless the error is explicit
+				if (symbol->type() == SymbolType::MULTITERMINAL) {
+					symbol = &symbol->shared_terminal();
+					action = state->evaluate(*symbol);
+				}
+			}
+			bool stop = evaluate(action, state_stack, tokenizer);
+			if (stop) {
+				bool error = action.type == ActionType::ERROR;
+				if (file.is_open()) {
+					if (error) {
+						file << "ERROR\n";
+					}
+					else {
+						file << "ACCEPT\n";
+					}
+				}
+				return !error;
+			}
+			if (file.is_open()) {
+				if (action.type == ActionType::SHIFT) {
+					file << "SHIFT\t" << std::setw(21)
+						<< std::left << tokenizer.text(token)
+						<< std::right << '(' << action.value << ")\n";
+				}
+				else if (action.type == ActionType::REDUCE) {
+					std::string s = "(" + std::to_string(state_stack.top()) + ")";
+					file << "REDUCE\t" << std::setw(20) << std::left
+						<< m_grammar->get_production(action.value)
+						<< std::setw(8) << std::right << s << '\n';
+				}
+			}
+			state = &m_builder->get_state(state_stack.top());
+		}
+		if (!tokenizer.result().success) {
+			// the token stream ends at a lexical error
+			if (file.is_open()) {
+				file << "ERROR\n";
+			}
+			return false;
+		}
+		if (!tokenizer.has_next()) {
+			auto action = state->evaluate(m_grammar->endmark());
+			while (action.type != ActionType::ACCEPT) {
+				if (action.type == ActionType::ERROR) {
+					if (file.is_open()) {
+						file << "ERROR\n";
+					}
+					return false;
+				}
+				assert(action.type == ActionType::REDUCE);
+				if (file.is_open()) {
+					std::string s = "(" + std::to_string(state_stack.top()) + ")";
+					file << "REDUCE\t" << std::setw(20) << std::left
+						<< m_grammar->get_production(action.value)
+						<< std::setw(8) << std::right << s << '\n';
+				}
+				auto& p = m_grammar->get_production(action.value);
+				for (size_t i = 0; i < p.rhs_count(); i++) {
+					state_stack.pop();
+				}
+				auto& top = m_builder->get_state(state_stack.top());
+				auto act = top.evaluate(p[0]);
+				if (act.type == ActionType::ERROR) {
+					return false;
+				}
+				assert(act.type == ActionType::GOTO);
+				state_stack.push(act.value);
+				state = &m_builder->get_state(state_stack.top());
+				action = state->evaluate(m_grammar->endmark());
+			}
+			file << "ACCEPT\n";
+		}
+
+		file.close();
+		return true;
+	}
+
+	bool Parser::evaluate(Action& action, std::stack<StateID>& stack, Tokenizer& tokenizer) {
+		switch (action.type) {
+			case ActionType::SHIFT:
+				stack.push(action.value);
+				tokenizer.next();
+				break;
+			case ActionType::REDUCE:
+			{
+				auto& p = m_grammar->get_production(action.value);
+				for (size_t i = 0; i < p.rhs_count(); i++) {
+					stack.pop();
+				}
+				auto& top = m_builder->get_state(stack.top());
+				auto act = top.evaluate(p[0]);
+				assert(act.type == ActionType::GOTO);
+				stack.push(act.value);
+			}
+			break;
+			case ActionType::ACCEPT:
+			case ActionType::ERROR:
+				return true;
+			default:
+				break;
+		}
+		return false;
+	}
+
+	template<typename Table>
+	bool Parser::drive(Tokenizer& tokenizer, const Table& lookup, bool report) {
+		std::ofstream file;
+		if (report) {
+			file.open("report\\parse", std::ios::trunc);
+		}
+
+		auto& table = *m_table;
+		// symbol indices of token types
+		std::vector<std::size_t> symbols;
+		for (std::size_t type = 0; type < tokenizer.type_count(); type++) {
+			symbols.push_back(table.symbol(tokenizer.type_name(type)));
+		}
+
+		std::vector<ParseTable::Row> state_stack {table.start()};
+		while (true) {
+			auto column = table.endmark();
+			if (tokenizer.has_next()) {
+				auto symbol = symbols[tokenizer.peek().type];
+				if (symbol == ParseTable::npos || table.is_nonterminal(symbol)) {
+					// error: the token is not a terminal of this grammar
+					if (file.is_open()) {
+						file << "ERROR\n";
+					}
+					return false;
+				}
+				column = table.column(symbol);
+			}
+			else if (!tokenizer.result().success) {
+				// the token stream ends at a lexical error
+				if (file.is_open()) {
+					file << "ERROR\n";
+				}
+				return false;
+			}
+			auto entry = lookup.action(state_stack.back(), column);
+			switch (ParseTable::type(entry)) {
+				case ActionType::SHIFT:
+				{
+					state_stack.push_back(ParseTable::Row(ParseTable::value(entry)));
+					auto& token = tokenizer.next();
+					if (file.is_open()) {
+						file << "SHIFT\t" << std::setw(21)
+							<< std::left << tokenizer.text(token) << std::right << '('
+							<< table.state_id(state_stack.back()) << ")\n";
+					}
+				}
+				break;
+				case ActionType::REDUCE:
+				{
+					auto pid = ParseTable::value(entry);
+					state_stack.resize(state_stack.size() - table.rhs_count(pid));
+					auto go = lookup.go(state_stack.back(), table.lhs(pid));
+					assert(ParseTable::type(go) == ActionType::GOTO);
+					state_stack.push_back(ParseTable::Row(ParseTable::value(go)));
+					if (file.is_open()) {
+						std::string s = "(" + std::to_string(table.state_id(state_stack.back())) + ")";
+						file << "REDUCE\t" << std::setw(20) << std::left;
+						table.print(file, pid);
+						file << std::setw(8) << std::right << s << '\n';
+					}
+				}
+				break;
+				case ActionType::ACCEPT:
+					if (file.is_open()) {
+						file << "ACCEPT\n";
+					}
+					return true;
+				default:
+					if (file.is_open()) {
+						file << "ERROR\n";
+					}
+					return false;
+			}
+		}
+	}
+
 }
\ No newline at end of file
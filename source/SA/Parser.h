@@ -1,34 +1,53 @@
-#pragma once
-
-#include "ItemSetBuilder.h"
-#include "Tokenizer.h"
-
-#include <stack>
-
-namespace pitaya {
-
-	/*!
-		\ingroup SA
-		Parser class.
-	*/
-	class Parser {
-
-	public:
-
-		//! Constructor.
-		Parser(Grammar&, ItemSetBuilder&);
-
-		//! Parse the token stream.
-		bool parse(Tokenizer&);
-
-	private:
-
-		Grammar& m_grammar;				//!< The grammar.
-		ItemSetBuilder& m_builder;		//!< The item-set builder.
-
-		//! Evaluate state transition against an action.
-		bool evaluate(Action&, std::stack<StateID>&, Tokenizer&);
-
-	};
-
+#pragma once
+
+#include "ItemSetBuilder.h"
+#include "PackedTable.h"
+#include "Tokenizer.h"
+
+#include <stack>
+
+namespace pitaya {
+
+	/*!
+		\ingroup SA
+		Parser class.
+	*/
+	class Parser {
+
+	public:
+
+		//! Constructor.
+		Parser(Grammar&, ItemSetBuilder&);
+
+		//! Construct a parser driven by compiled tables only.
+		Parser(const ParseTable&);
+
+		//! Construct a parser driven by compressed tables only.
+		Parser(const PackedTable&);
+
+		//! Parse the token stream.
+		/*!
+			\param report Whether to trace the parse to the report file.
+		*/
+		bool parse(Tokenizer&, bool report = true);
+
+	private:
+
+		Grammar* m_grammar;				//!< The grammar.
+		ItemSetBuilder* m_builder;		//!< The item-set builder.
+		const ParseTable* m_table;		//!< The compiled tables.
+		const PackedTable* m_packed;	//!< The compressed tables.
+
+		//! Evaluate state transition against an action.
+		bool evaluate(Action&, std::stack<StateID>&, Tokenizer&);
+
+		//! Parse the token stream with compiled tables.
+		/*!
+			\param lookup Either the ParseTable itself or its PackedTable.
+		*/
+		template<typename Table>
+		bool drive(Tokenizer&, const Table& lookup, bool report);
+
+	};
+
 }
\ No newline at end of file
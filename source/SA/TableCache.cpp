@@ -0,0 +1,97 @@
+#include "TableCache.h"
+#include "StateBuilder.h"
+#include "ItemSetBuilder.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <boost\filesystem.hpp>
+
+namespace pitaya {
+
+	namespace fs = boost::filesystem;
+
+	TableCache::TableCache(const std::string& directory)
+		: m_directory {directory}, m_hits {}, m_misses {} {}
+
+	std::unique_ptr<LexTable> TableCache::lex_table(Grammar& grammar) {
+		auto file = path(grammar, ".lex");
+		std::ifstream is;
+		is.open(file, std::ios::binary);
+		if (is.is_open()) {
+			auto table = LexTable::load(is);
+			if (table) {
+				m_hits++;
+				return table;
+			}
+		}
+		is.close();
+
+		m_misses++;
+		StateBuilder builder {grammar};
+		builder.build();
+		auto table = std::make_unique<LexTable>(grammar, builder);
+		store(*table, file);
+		return table;
+	}
+
+	std::unique_ptr<ParseTable> TableCache::parse_table(Grammar& grammar, std::size_t threads, bool bypass_units) {
+		auto file = path(grammar, bypass_units ? ".units.parse" : ".parse");
+		std::ifstream is;
+		is.open(file, std::ios::binary);
+		if (is.is_open()) {
+			auto table = ParseTable::load(is);
+			if (table) {
+				m_hits++;
+				return table;
+			}
+		}
+		is.close();
+
+		m_misses++;
+		// the builder is large, only the table is kept
+		auto builder = std::make_unique<ItemSetBuilder>(grammar);
+		builder->build(threads);
+		if (bypass_units) {
+			builder->bypass_unit_reductions();
+		}
+		auto table = std::make_unique<ParseTable>(grammar, *builder);
+		store(*table, file);
+		return table;
+	}
+
+	std::size_t TableCache::hits() const {
+		return m_hits;
+	}
+
+	std::size_t TableCache::misses() const {
+		return m_misses;
+	}
+
+	std::string TableCache::path(const Grammar& grammar, const char* extension) const {
+		std::ostringstream name;
+		name << std::hex << std::setw(16) << std::setfill('0') << grammar.fingerprint() << extension;
+		return (fs::path(m_directory) / name.str()).string();
+	}
+
+	template<typename Table>
+	void TableCache::store(const Table& table, const std::string& path) const {
+		// a cache that cannot be written only costs a rebuild next time
+		boost::system::error_code error;
+		fs::create_directories(m_directory, error);
+		auto temp = fs::unique_path(path + ".%%%%%%%%", error);
+		if (error) return;
+		std::ofstream os;
+		os.open(temp.string(), std::ios::binary | std::ios::trunc);
+		bool good = os.is_open() && table.save(os);
+		os.close();
+		if (good) {
+			fs::rename(temp, path, error);
+		}
+		if (!good || error) {
+			fs::remove(temp, error);
+		}
+	}
+
+}
\ No newline at end of file
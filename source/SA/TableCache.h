@@ -0,0 +1,62 @@
+#pragma once
+
+#include "LexTable.h"
+#include "ParseTable.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace pitaya {
+
+	/*!
+		\ingroup SA
+		TableCache class.
+
+		A directory of compiled tables keyed by Grammar::fingerprint().
+		A table is loaded from the directory if a grammar with the same fingerprint has been built before,
+		otherwise it is built and stored for the next time.
+		Files that fail to load, e.g. of an older format version, are rebuilt and replaced.
+	*/
+	class TableCache {
+
+	public:
+
+		//! Constructor.
+		/*!
+			\param directory The cache directory, created when a table is first stored.
+		*/
+		TableCache(const std::string& directory);
+
+		//! Lexer table of a lexical grammar.
+		std::unique_ptr<LexTable> lex_table(Grammar&);
+
+		//! Parser table of a syntax grammar.
+		/*!
+			\param threads Passed to ItemSetBuilder::build() on a miss.
+			\param bypass_units Whether unit reductions are bypassed, such tables are cached apart.
+		*/
+		std::unique_ptr<ParseTable> parse_table(Grammar&, std::size_t threads = 1, bool bypass_units = false);
+
+		//! Number of tables loaded from the cache.
+		std::size_t hits() const;
+
+		//! Number of tables built.
+		std::size_t misses() const;
+
+	private:
+
+		std::string m_directory;	//!< The cache directory.
+		std::atomic<std::size_t> m_hits;	//!< Number of tables loaded from the cache.
+		std::atomic<std::size_t> m_misses;	//!< Number of tables built.
+
+		//! Path of the table of a grammar.
+		std::string path(const Grammar&, const char* extension) const;
+
+		//! Store a table through a temporary file, so that no reader sees a partial one.
+		template<typename Table>
+		void store(const Table&, const std::string& path) const;
+
+	};
+
+}
\ No newline at end of file
@@ -1,85 +1,215 @@
-#include "Grammar.h"
-#include "StateBuilder.h"
-#include "Tokenizer.h"
-#include "ItemSetBuilder.h"
-#include "Parser.h"
-
-#include <string>
-#include <memory>
-#include <fstream>
-#include <iostream>
-
-#include <boost\program_options.hpp>
-namespace po = boost::program_options;
-
-using namespace pitaya;
-
-int main(int argc, char* argv[]) {
-
-	po::options_description opt("Options");
-	opt.add_options()
-		("help,h", "show help message")
-		("lexical", po::value<std::string>(), "lexical spec file")
-		("syntax", po::value<std::string>(), "syntax spec file")
-		("source,s", po::value<std::string>(), "source file")
-		("silence", "do not report")
-		("graph", "generate dot graph");
-
-	po::variables_map vm;
-	po::store(po::parse_command_line(argc, argv, opt), vm);
-	po::notify(vm);
-
-	if (vm.count("help")) {
-		std::cout << opt << std::endl;
-		return 0;
-	}
-
-	if (vm.count("lexical") && vm.count("syntax") && vm.count("source")) {
-		auto lexical {std::make_unique<Grammar>(vm["lexical"].as<std::string>())};
-		auto builder1 {std::make_unique<StateBuilder>(*lexical)};
-		builder1->build();
-		if (!vm.count("silence")) {
-			bool graph = vm.count("graph") != 0;
-			builder1->report(graph);
-		}
-
-		auto tokenizer {std::make_unique<Tokenizer>(*lexical, *builder1)};
-		std::ifstream f;
-		f.open(vm["source"].as<std::string>());
-		if (f.is_open()) {
-			auto res = tokenizer->parse(f);
-			if (!res.success) {
-				std::cout << "[ERROR] line " << res.err_line << ": " << res.err_input << std::endl;
-			}
-		}
-		f.close();
-		if (!vm.count("silence")) {
-			tokenizer->report();
-		}
-
-		Symbol::clear();
-
-		auto syntax {std::make_unique<Grammar>(vm["syntax"].as<std::string>())};
-		auto builder2 {std::make_unique<ItemSetBuilder>(*syntax)};
-		builder2->build();
-		if (!vm.count("silence")) {
-			bool graph = vm.count("graph") != 0;
-			builder2->report(graph);
-		}
-
-		auto parser {std::make_unique<Parser>(*syntax,*builder2)};
-		auto acc = parser->parse(*tokenizer);
-		if (!acc) {
-			std::cout << "ERROR";
-		}
-		else {
-			std::cout << "ACCEPT";
-		}
-	}
-	else {
-		std::cout << opt << std::endl;
-	}
-
-	return 0;
-
+#include "Grammar.h"
+#include "StateBuilder.h"
+#include "LexTable.h"
+#include "Tokenizer.h"
+#include "ItemSetBuilder.h"
+#include "PackedTable.h"
+#include "CodeGenerator.h"
+#include "TableCache.h"
+#include "Parser.h"
+
+#include <string>
+#include <memory>
+#include <fstream>
+#include <future>
+#include <iostream>
+
+#include <boost\program_options.hpp>
+namespace po = boost::program_options;
+
+using namespace pitaya;
+
+int main(int argc, char* argv[]) {
+
+	po::options_description opt("Options");
+	opt.add_options()
+		("help,h", "show help message")
+		("lexical", po::value<std::string>(), "lexical spec file")
+		("syntax", po::value<std::string>(), "syntax spec file")
+		("source,s", po::value<std::string>(), "source file")
+		("dfa", "tokenize with a compiled DFA")
+		("stream", "tokenize on demand while parsing")
+		("table", "parse with compiled tables")
+		("packed", "parse with compressed tables")
+		("save-tables", po::value<std::string>(), "save the compiled lexer and parser tables to a file")
+		("load-tables", po::value<std::string>(), "parse with tables loaded from a file, no grammar is needed")
+		("generate", po::value<std::string>(), "generate a C++ header with constexpr tables and a parser driver")
+		("cache", po::value<std::string>(), "load tables from a cache directory, building and storing them on a miss")
+		("threads", po::value<std::size_t>()->default_value(1), "threads building the parse table, 0 for all")
+		("bypass-units", "skip unit reductions by rewriting gotos, the skipped ones are reported")
+		("silence", "do not report")
+		("graph", "generate dot graph");
+
+	po::variables_map vm;
+	po::store(po::parse_command_line(argc, argv, opt), vm);
+	po::notify(vm);
+
+	if (vm.count("help")) {
+		std::cout << opt << std::endl;
+		return 0;
+	}
+
+	bool load = vm.count("load-tables") != 0;
+	bool save = vm.count("save-tables") != 0;
+	bool generate = vm.count("generate") != 0;
+	std::unique_ptr<TableCache> cache;
+	if (vm.count("cache") && !load) {
+		cache = std::make_unique<TableCache>(vm["cache"].as<std::string>());
+	}
+	if ((load || (vm.count("lexical") && vm.count("syntax"))) && vm.count("source")) {
+		std::unique_ptr<Grammar> lexical, syntax;
+		std::unique_ptr<StateBuilder> builder1;
+		std::unique_ptr<ItemSetBuilder> builder2;
+		std::unique_ptr<LexTable> dfa;
+		std::unique_ptr<ParseTable> table;
+		std::unique_ptr<PackedTable> packed;
+		std::unique_ptr<Tokenizer> tokenizer;
+		std::unique_ptr<Parser> parser;
+
+		bool stream = vm.count("stream") != 0;
+		bool silence = vm.count("silence") != 0;
+		bool graph = vm.count("graph") != 0;
+		auto threads = vm["threads"].as<std::size_t>();
+		bool bypass_units = vm.count("bypass-units") != 0;
+
+		// grammars share no state, so the parser tables are built while the source is tokenized
+		std::future<void> syntax_ready;
+		if (!load) {
+			syntax_ready = std::async(std::launch::async, [&] {
+				syntax = std::make_unique<Grammar>(vm["syntax"].as<std::string>());
+				if (cache) {
+					table = cache->parse_table(*syntax, threads, bypass_units);
+				}
+				else {
+					builder2 = std::make_unique<ItemSetBuilder>(*syntax);
+					builder2->build(threads);
+					if (bypass_units) {
+						builder2->bypass_unit_reductions();
+					}
+					if (!silence) {
+						builder2->report(graph);
+					}
+
+					if (vm.count("packed") || vm.count("table") || save || generate) {
+						table = std::make_unique<ParseTable>(*syntax, *builder2);
+					}
+				}
+			});
+		}
+
+		if (load) {
+			// both tables are read back, no grammar is built
+			std::ifstream tables;
+			tables.open(vm["load-tables"].as<std::string>(), std::ios::binary);
+			dfa = LexTable::load(tables);
+			table = dfa ? ParseTable::load(tables) : nullptr;
+			tables.close();
+			if (!table) {
+				std::cout << "[ERROR] cannot load tables from " << vm["load-tables"].as<std::string>() << std::endl;
+				return 1;
+			}
+			tokenizer = std::make_unique<Tokenizer>(*dfa);
+		}
+		else {
+			lexical = std::make_unique<Grammar>(vm["lexical"].as<std::string>());
+			if (cache) {
+				// no builder is kept, so scan with the table
+				dfa = cache->lex_table(*lexical);
+				tokenizer = std::make_unique<Tokenizer>(*dfa);
+			}
+			else {
+				builder1 = std::make_unique<StateBuilder>(*lexical);
+				builder1->build();
+				if (!silence) {
+					builder1->report(graph);
+				}
+
+				if (vm.count("dfa") || save || generate) {
+					dfa = std::make_unique<LexTable>(*lexical, *builder1);
+				}
+				if (vm.count("dfa")) {
+					tokenizer = std::make_unique<Tokenizer>(*dfa);
+				}
+				else {
+					tokenizer = std::make_unique<Tokenizer>(*lexical, *builder1);
+				}
+			}
+		}
+
+		std::ifstream f;
+		f.open(vm["source"].as<std::string>());
+		if (f.is_open()) {
+			if (stream) {
+				// the file is read while parsing
+				tokenizer->open(f);
+			}
+			else {
+				auto res = tokenizer->parse(f);
+				if (!res.success) {
+					std::cout << "[ERROR] line " << res.err_line << ": " << res.err_input << std::endl;
+				}
+			}
+		}
+		if (!stream) {
+			f.close();
+			if (!silence) {
+				tokenizer->report();
+			}
+		}
+
+		if (!load) {
+			syntax_ready.get();
+			if (save) {
+				std::ofstream tables;
+				tables.open(vm["save-tables"].as<std::string>(), std::ios::binary | std::ios::trunc);
+				if (!dfa->save(tables) || !table->save(tables)) {
+					std::cout << "[ERROR] cannot save tables to " << vm["save-tables"].as<std::string>() << std::endl;
+				}
+				tables.close();
+			}
+		}
+
+		if (generate) {
+			std::ofstream header;
+			header.open(vm["generate"].as<std::string>(), std::ios::trunc);
+			if (!CodeGenerator(*dfa, *table).generate(header, "pitaya_generated")) {
+				std::cout << "[ERROR] cannot generate " << vm["generate"].as<std::string>() << std::endl;
+			}
+			header.close();
+		}
+
+		if (vm.count("packed")) {
+			packed = std::make_unique<PackedTable>(*table);
+			if (!silence) {
+				packed->report();
+			}
+			parser = std::make_unique<Parser>(*packed);
+		}
+		else if (vm.count("table") || load || cache) {
+			parser = std::make_unique<Parser>(*table);
+		}
+		else {
+			parser = std::make_unique<Parser>(*syntax, *builder2);
+		}
+		auto acc = parser->parse(*tokenizer, !silence);
+		if (stream) {
+			auto& res = tokenizer->result();
+			if (!res.success) {
+				std::cout << "[ERROR] line " << res.err_line << ": " << res.err_input << std::endl;
+			}
+			f.close();
+		}
+		if (!acc) {
+			std::cout << "ERROR";
+		}
+		else {
+			std::cout << "ACCEPT";
+		}
+	}
+	else {
+		std::cout << opt << std::endl;
+	}
+
+	return 0;
+
 }
\ No newline at end of file